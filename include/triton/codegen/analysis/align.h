@@ -16,6 +16,8 @@ namespace ir {
   class broadcast_inst;
   class binary_operator;
   class getelementptr_inst;
+  class cmp_inst;
+  class select_inst;
 }
 
 namespace codegen{
@@ -26,9 +28,12 @@ private:
   struct cst_info {
     unsigned num_cst;
     unsigned value;
+    bool operator==(const cst_info& other) const { return num_cst == other.num_cst && value == other.value; }
   };
   // helpers
   std::vector<unsigned> get_shapes(ir::value *v);
+  std::vector<unsigned> pred_constancy(ir::select_inst *x);
+  unsigned element_multiple(ir::value *v);
   // populate is_constant
   std::vector<cst_info> populate_is_constant_phi(ir::phi_node* x);
   std::vector<cst_info> populate_is_constant_splat(ir::splat_inst* x);
@@ -36,6 +41,8 @@ private:
   std::vector<cst_info> populate_is_constant_broadcast(ir::broadcast_inst* x);
   std::vector<cst_info> populate_is_constant_binop(ir::binary_operator* x);
   std::vector<cst_info> populate_is_constant_gep(ir::getelementptr_inst* x);
+  std::vector<cst_info> populate_is_constant_cmp(ir::cmp_inst* x);
+  std::vector<cst_info> populate_is_constant_select(ir::select_inst* x);
   std::vector<cst_info> populate_is_constant_default(ir::value* v);
   std::vector<cst_info> populate_is_constant(ir::value *v);
   // populate max_contiguous
@@ -46,6 +53,7 @@ private:
   std::vector<unsigned> populate_max_contiguous_binop(ir::binary_operator* x);
   std::vector<unsigned> populate_max_contiguous_gep(ir::getelementptr_inst* x);
   std::vector<unsigned> populate_max_contiguous_cast(ir::cast_inst* x);
+  std::vector<unsigned> populate_max_contiguous_select(ir::select_inst* x);
   std::vector<unsigned> populate_max_contiguous_default(ir::value* v);
   std::vector<unsigned> populate_max_contiguous(ir::value *v);
   // populate starting_multiple
@@ -56,6 +64,7 @@ private:
   std::vector<unsigned> populate_starting_multiple_binop(ir::binary_operator* x);
   std::vector<unsigned> populate_starting_multiple_gep(ir::getelementptr_inst* x);
   std::vector<unsigned> populate_starting_multiple_cast(ir::cast_inst* x);
+  std::vector<unsigned> populate_starting_multiple_select(ir::select_inst* x);
   std::vector<unsigned> populate_starting_multiple_default(ir::value* v);
   std::vector<unsigned> populate_starting_multiple(ir::value *v);
   // populate all maps
@@ -65,11 +74,17 @@ public:
   void run(ir::module &mod);
   unsigned get(ir::value* v, unsigned ax) const;
   std::vector<unsigned> contiguous(ir::value* v) const;
+  std::vector<unsigned> constancy(ir::value* v) const;
 
 private:
   std::map<ir::value*, std::vector<cst_info>> is_constant_;
   std::map<ir::value*, std::vector<unsigned>> max_contiguous_;
   std::map<ir::value*, std::vector<unsigned>> starting_multiple_;
+  // what loop-carried phis are assumed to be while their loop is analyzed
+  std::map<ir::value*, std::vector<cst_info>> assumed_is_constant_;
+  std::map<ir::value*, std::vector<unsigned>> assumed_max_contiguous_;
+  std::map<ir::value*, std::vector<unsigned>> assumed_starting_multiple_;
+  bool changed_;
 };
 
 
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <iostream>
 #include "triton/codegen/analysis/liveness.h"
 
@@ -22,22 +23,38 @@ class tiles;
 class liveness;
 class cts;
 
+// Places shared buffers whose live ranges overlap at disjoint offsets.
+// Buffers are placed by decreasing size (then lifetime) in the smallest
+// gap left by the buffers they interfere with. When there are at most
+// `max_exact` buffers and the result is above the peak of live bytes,
+// an exhaustive search over normalized placements looks for a better one.
 class allocation {
+  typedef std::map<shared_layout*, unsigned> offsets_t;
+  typedef std::map<shared_layout*, std::vector<shared_layout*>> interferences_t;
+
+private:
+  size_t best_fit(const std::vector<shared_layout*>& V, const interferences_t& interferences, offsets_t& offsets);
+  size_t exact(const std::vector<shared_layout*>& V, const interferences_t& interferences, size_t bound, offsets_t& offsets);
+
 public:
-  allocation(liveness *live)
-    : liveness_(live) { }
+  allocation(liveness *live, unsigned max_exact = 8, unsigned alignment = 16)
+    : liveness_(live), max_exact_(max_exact), alignment_(alignment) { }
   // accessors
   bool has_offset(const data_layout *x)    const { return offsets_.find(x) != offsets_.end(); }
   unsigned offset(const data_layout *x)    const { return offsets_.at(x); }
   unsigned allocated_size()        const { return allocated_size_; }
+  unsigned peak_live_size()        const { return peak_live_size_; }
   // run
   void run(ir::module& mod);
 
 private:
   std::map<const data_layout*, unsigned> offsets_;
   size_t allocated_size_;
+  size_t peak_live_size_;
   // dependences
   liveness *liveness_;
+  unsigned max_exact_;
+  unsigned alignment_;
 };
 
 }
@@ -0,0 +1,61 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_BANK_CONFLICTS_H
+#define TRITON_INCLUDE_IR_CODEGEN_BANK_CONFLICTS_H
+
+#include <map>
+#include <vector>
+#include <cstdint>
+
+namespace triton{
+
+namespace ir{
+  class module;
+  class value;
+}
+
+namespace codegen{
+class target;
+
+namespace analysis{
+
+class layouts;
+class swizzle;
+class shared_layout;
+class scanline_layout;
+
+// Statically computes, for the first warp, the worst-case bank-conflict
+// degree of the shared memory accesses emitted for each instruction:
+// copies to shared memory, operand reads of dots, and both sides of
+// recoalesce. A degree of 1 means conflict-free.
+class bank_conflicts {
+  typedef std::vector<int> coord_t;
+
+private:
+  int64_t offset(shared_layout *layout, const coord_t &coord);
+  coord_t lane_coord(scanline_layout *layout, int lane);
+  int degree(const std::vector<int64_t> &addrs, int width);
+  void add(ir::value *v, int degree);
+  void visit_copy_to_shared(ir::value *cts, ir::value *arg);
+  void visit_dot(ir::value *dot);
+  void visit_recoalesce(ir::value *rc);
+
+public:
+  bank_conflicts(layouts *l, swizzle *s, target *tgt): layouts_(l), swizzle_(s), tgt_(tgt) { }
+  void run(ir::module &mod);
+  // accessors
+  int get(ir::value *v) const          { return degrees_.count(v) ? degrees_.at(v) : 1; }
+  unsigned num_accesses() const        { return degrees_.size(); }
+  unsigned num_conflicting() const;
+  int max_degree() const;
+
+private:
+  layouts* layouts_;
+  swizzle* swizzle_;
+  target* tgt_;
+  std::map<ir::value*, int> degrees_;
+};
+
+}
+}
+}
+
+#endif
@@ -16,6 +16,7 @@ namespace ir{
   class module;
   class instruction;
   class phi_node;
+  class reduce_inst;
 }
 
 namespace codegen{
@@ -129,6 +130,10 @@ struct scanline_layout: public data_layout {
   // accessor
   int mts(size_t k) { return mts_.at(k); }
   int nts(size_t k) { return nts_.at(k); }
+  // distance between consecutive threads along axis `k`
+  int thread_stride(size_t k);
+  // number of warps spanned by the threads along axis `k`
+  int warps_along(size_t k);
 
 public:
   std::vector<int> mts_;
@@ -205,6 +210,7 @@ private:
   void init_scanline_tile(data_layout &layouts);
 
   void create(size_t id, const std::vector<ir::value*>& values);
+  void fuse_reductions(ir::module &mod);
 
 public:
   // constructor
@@ -219,6 +225,10 @@ public:
   std::map<size_t, data_layout*> &get_all()                   { return layouts_; }
   bool has_tmp(ir::value* i)                                  { return tmp_.find(i) != tmp_.end(); }
   int tmp(ir::value* i)                                       { return tmp_.at(i);}
+  // reductions emitted together with `red` (including itself), in program order
+  const std::vector<ir::reduce_inst*>& fused_with(ir::reduce_inst* red) { return fused_.at(red); }
+  bool is_fused(ir::reduce_inst* red)                         { return fused_.at(red).back() != red; }
+  unsigned num_fused_reductions() const                       { return num_fused_; }
 
   // execution
   void run(ir::module &mod);
@@ -233,6 +243,8 @@ private:
   std::map<size_t, std::vector<ir::value*>> values_;
   std::map<size_t, data_layout*> layouts_;
   std::map<ir::value*, size_t> tmp_;
+  std::map<ir::reduce_inst*, std::vector<ir::reduce_inst*>> fused_;
+  unsigned num_fused_;
 };
 
 }
@@ -34,22 +34,63 @@ struct segment {
     return start <= idx && idx < end;
   }
 
-  bool intersect(const segment &Other){
+  bool intersect(const segment &Other) const {
     return contains(Other.start) || Other.contains(start);
   }
 };
 
+// Sorted, disjoint segments of instruction slots
+struct live_range {
+  std::vector<segment> segments;
+
+  slot_index start() const { return segments.front().start; }
+  slot_index end() const { return segments.back().end; }
+
+  slot_index length() const {
+    slot_index ret = 0;
+    for(const segment& s: segments)
+      ret += s.end - s.start;
+    return ret;
+  }
+
+  bool contains(slot_index idx) const {
+    for(const segment& s: segments)
+      if(s.contains(idx))
+        return true;
+    return false;
+  }
+
+  bool intersect(const live_range &Other) const {
+    for(const segment& x: segments)
+    for(const segment& y: Other.segments)
+      if(x.intersect(y))
+        return true;
+    return false;
+  }
+};
+
+// A shared buffer is live at an instruction if that instruction is
+// reachable from a write of the buffer and some read of the buffer is
+// reachable from it, along control-flow edges. Writes of single-stage
+// buffers overwrite their content, so their reads cannot be reached
+// through them: temporaries of a loop body are not live around its back
+// edge and temporaries of an if-branch are not live in the other one.
+
 
 class liveness {
 private:
-  typedef std::map<shared_layout*, segment>    intervals_map_t;
+  typedef std::map<shared_layout*, live_range> intervals_map_t;
+  typedef std::map<ir::instruction*, slot_index> indices_map_t;
+
+private:
+  live_range compute(shared_layout* layout, ir::function* fn, const indices_map_t& indices);
 
 public:
   // constructor
   liveness(layouts *l): layouts_(l){ }
   // accessors
   const intervals_map_t& get()  const { return intervals_; }
-  segment get(shared_layout* v)  const { return intervals_.at(v); }
+  const live_range& get(shared_layout* v) const { return intervals_.at(v); }
   // run
   void run(ir::module &mod);
 
@@ -3,6 +3,8 @@
 
 
 #include <memory>
+#include <map>
+#include <string>
 
 namespace triton{
 
@@ -19,9 +21,12 @@ namespace driver{
 namespace triton{
 namespace codegen{
 
+// statistics gathered by the passes, e.g. {"dce.dead_branches": 2}
+typedef std::map<std::string, int> report_t;
+
 // TODO:
 // There should be a proper pass manager there!
-void add_passes_to_emit_bin(ir::module &ir, driver::device* dev, int num_warps, int num_stages, bool force_nc_cache,
+report_t add_passes_to_emit_bin(ir::module &ir, driver::device* dev, int num_warps, int num_stages, bool force_nc_cache, int unroll_max_size,
                             driver::module*& mod, driver::kernel*& ker, size_t& shared_mem);
 
 
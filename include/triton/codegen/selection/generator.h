@@ -30,6 +30,8 @@ namespace triton{
 
 namespace ir{
 class attribute;
+class io_inst;
+enum class atomic_rmw_op_t: unsigned int;
 class load_inst;
 class store_inst;
 }
@@ -137,6 +139,19 @@ public:
   std::tuple<Value*, Value*, Value*, Value*> fp16x4_to_fp8x4(Value *in0, Value *in1, Value *in2, Value *in3);
   Value* bf16_to_fp32(Value *in0);
   Value* fp32_to_bf16(Value *in0);
+  bool is_x2_packable(ir::value *x);
+  Value* approx_f32(const std::string &op, Value *x);
+  Value* polynomial(Value *x, const std::vector<double> &coeffs);
+  Value* exp_reduced_f32(Value *r, Value *n);
+  Value* exp_f32(Value *x, bool base2, bool approx);
+  Value* rcp_f32(Value *x, bool approx);
+  void visit_math_inst(ir::math_inst *x, std::function<Value*(const std::vector<Value*>&)> fn);
+  Value* pack_x2(Value *in0, Value *in1);
+  std::string cache_operator(ir::io_inst* x);
+  Value* atomic_rmw_asm(ir::atomic_rmw_op_t op, Value *pred, Value *ptr, Value *val);
+  bool visit_aggregated_atomic_rmw(ir::atomic_rmw_inst*);
+  Value* cache_policy(ir::io_inst* x);
+  size_t vector_width(ir::io_inst* x, ir::value *ptr, int axis, size_t nts);
 
   void visit_cast_inst(ir::cast_inst*);
   void visit_return_inst(ir::return_inst*);
@@ -156,6 +171,12 @@ public:
   void visit_cos_inst(ir::cos_inst*);
   void visit_sin_inst(ir::sin_inst*);
   void visit_log_inst(ir::log_inst*);
+  void visit_exp2_inst(ir::exp2_inst*);
+  void visit_tanh_inst(ir::tanh_inst*);
+  void visit_erf_inst(ir::erf_inst*);
+  void visit_sigmoid_inst(ir::sigmoid_inst*);
+  void visit_rsqrt_inst(ir::rsqrt_inst*);
+  void visit_pow_inst(ir::pow_inst*);
   void visit_get_program_id_inst(ir::get_program_id_inst*);
   void visit_get_num_programs_inst(ir::get_num_programs_inst*);
   void visit_atomic_cas_inst(ir::atomic_cas_inst*);
@@ -167,9 +188,10 @@ public:
   void visit_dot_inst(ir::dot_inst*);
   void visit_trans_inst(ir::trans_inst*);
   void visit_sqrt_inst(ir::sqrt_inst*);
-  void visit_reduce1d_inst(ir::reduce_inst*, std::function<Value*(Value*,Value*)>, Value*);
-  void visit_reducend_inst(ir::reduce_inst*, std::function<Value*(Value*,Value*)>, Value*);
+  Value* shfl_sync(Value *val, const std::string &mode, Value *arg);
+  std::vector<Value*> shfl_bfly(const std::vector<Value*>& vals, int i);
   void visit_reduce_inst(ir::reduce_inst*);
+  void visit_scan_inst(ir::scan_inst*);
   void visit_select_inst(ir::select_inst*);
   void visit_recoalesce_inst(ir::recoalesce_inst*);
   void visit_masked_load_async_inst(ir::masked_load_async_inst*);
@@ -189,6 +211,7 @@ public:
   void visit_basic_block(ir::basic_block*);
   void visit_argument(ir::argument*);
   void visit(ir::module &, llvm::Module &);
+  unsigned num_align_limited() const { return num_align_limited_; }
 
   // layouts
   void visit_layout_mma(analysis::mma_layout*);
@@ -213,6 +236,7 @@ private:
 
   unsigned num_warps_;
   bool force_nc_cache_;
+  unsigned num_align_limited_;
 
   std::map<analysis::data_layout*, Value*> offset_a_m_;
   std::map<analysis::data_layout*, Value*> offset_a_k_;
@@ -11,6 +11,7 @@ namespace ir {
   class module;
   class value;
   class io_inst;
+  class store_inst;
   class instruction;
   class builder;
 }
@@ -30,14 +31,23 @@ private:
   void extract_io_use(ir::value *v, std::set<ir::io_inst*>& result);
   void extract_ld(ir::io_inst *i, std::map<int, std::vector<triton::ir::io_inst *> > &result);
   ir::value* rematerialize(ir::value *v, ir::builder& builder, std::map<ir::value*, ir::value*>& seen);
+  bool is_staging_profitable(ir::store_inst *x);
+  bool is_staging_legal(ir::store_inst *x);
+  double access_cost(ir::io_inst *i, int axis, bool *convert);
 
 public:
   coalesce(analysis::align* align, triton::codegen::analysis::layouts *layouts);
   void run(ir::module &mod);
+  unsigned num_staged_stores() const { return num_staged_stores_; }
+  unsigned num_conversions() const { return num_conversions_; }
+  int num_avoided_conversions() const { return num_avoided_conversions_; }
 
 private:
   analysis::align* align_;
   analysis::layouts* layout_;
+  unsigned num_staged_stores_;
+  unsigned num_conversions_;
+  int num_avoided_conversions_;
 };
 
 }
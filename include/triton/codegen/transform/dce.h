@@ -6,15 +6,35 @@ namespace triton {
 
 namespace ir {
   class module;
+  class function;
 }
 
 namespace codegen{
 namespace transform{
 
+// Aggressive dead-code elimination: instructions are dead unless they
+// (transitively) feed a side effect. Conditional branches are live only when a
+// live instruction is control-dependent on them (post-dominance frontier);
+// dead branches jump to their immediate post-dominator instead, and blocks
+// left unreachable are removed.
 class dce {
+private:
+  void run(ir::function *fn, ir::module &mod);
+
 public:
-  dce() {}
+  dce(): num_dead_insts_(0), num_dead_phis_(0), num_dead_branches_(0), num_dead_blocks_(0) {}
   void run(ir::module &mod);
+  // statistics, accumulated over all runs
+  unsigned num_dead_insts() const { return num_dead_insts_; }
+  unsigned num_dead_phis() const { return num_dead_phis_; }
+  unsigned num_dead_branches() const { return num_dead_branches_; }
+  unsigned num_dead_blocks() const { return num_dead_blocks_; }
+
+private:
+  unsigned num_dead_insts_;
+  unsigned num_dead_phis_;
+  unsigned num_dead_branches_;
+  unsigned num_dead_blocks_;
 };
 
 }
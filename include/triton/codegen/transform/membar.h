@@ -11,6 +11,7 @@ namespace triton {
 
 namespace ir {
   class module;
+  class function;
   class basic_block;
   class instruction;
   class masked_load_async_inst;
@@ -47,13 +48,22 @@ private:
   bool intersect_with(analysis::shared_layout* a_layout, analysis::shared_layout* b_layout);
   val_set_t intersect_with(const val_set_t& as, const val_set_t& bs);
   void transfer(ir::basic_block *block, val_vec_t &async_write, val_set_t &sync_write, val_set_t &sync_read,
-                std::set<triton::ir::value *> &safe_war, bool &inserted, ir::builder &builder);
+                std::set<triton::ir::value *> &safe_war, bool &inserted, ir::builder &builder, bool dry_run);
+  bool propagate(ir::function *fn, std::set<ir::value*>& safe_war, ir::builder &builder, bool dry_run);
+  void minimize(ir::function *fn, std::set<ir::value*>& safe_war, const std::set<ir::value*>& keep,
+                ir::builder &builder);
+  unsigned count_barriers(ir::module &mod);
 
 public:
   membar(analysis::liveness *liveness, analysis::layouts *layouts, analysis::allocation *alloc, 
          transform::prefetch *prefetch, target* tgt):
-    liveness_(liveness), layouts_(layouts), alloc_(alloc), prefetch_(prefetch), tgt_(tgt) {}
+    liveness_(liveness), layouts_(layouts), alloc_(alloc), prefetch_(prefetch), tgt_(tgt),
+    num_inserted_barriers_(0), num_barriers_(0) {}
   void run(ir::module &mod);
+  // barriers inserted by the pass, before and after removing the
+  // redundant ones. Barriers written by the user are not counted
+  unsigned num_inserted_barriers() const { return num_inserted_barriers_; }
+  unsigned num_barriers() const { return num_barriers_; }
 
 private:
   analysis::liveness *liveness_;
@@ -62,6 +72,8 @@ private:
   transform::prefetch *prefetch_;
 
   target* tgt_;
+  unsigned num_inserted_barriers_;
+  unsigned num_barriers_;
 };
 
 
@@ -15,12 +15,17 @@ namespace transform {
 class pipeline {
 public:
   pipeline(bool has_copy_async, int num_stages)
-      : has_copy_async_(has_copy_async), num_stages_(num_stages) {}
+      : has_copy_async_(has_copy_async), num_stages_(num_stages),
+        num_pipelined_loads_(0), num_staged_loads_(0) {}
   void run(ir::module &module);
+  unsigned num_pipelined_loads() const { return num_pipelined_loads_; }
+  unsigned num_staged_loads() const { return num_staged_loads_; }
 
 private:
   bool has_copy_async_;
   int num_stages_;
+  unsigned num_pipelined_loads_;
+  unsigned num_staged_loads_;
 };
 
 } // namespace transform
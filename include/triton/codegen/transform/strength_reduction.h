@@ -0,0 +1,63 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_STRENGTH_REDUCTION_H
+#define TRITON_INCLUDE_IR_CODEGEN_STRENGTH_REDUCTION_H
+
+#include <map>
+#include <cstdint>
+
+namespace triton {
+
+// forward declaration
+namespace ir {
+class module;
+class value;
+class instruction;
+class basic_block;
+class builder;
+}
+
+namespace codegen{
+namespace transform{
+
+// Scalar strength reduction:
+//   - signed division/remainder of non-negative 32-bit integers by
+//     constants become shifts/masks (powers of two) or multiply-shift
+//     sequences (other divisors);
+//   - signed division/remainder of non-negative 32-bit integers by
+//     runtime scalars become a multiply-high by a fixed-point inverse
+//     of the divisor, computed once right after the divisor is defined,
+//     followed by two correction steps;
+//   - multiplications of a loop induction variable by a loop invariant
+//     become a new induction variable updated with additions.
+// Block-typed index math is left alone, as `align` reasons about
+// divisions of ranges directly.
+class strength_reduction {
+  struct inverse_t {
+    ir::value *abs;  // |d|
+    ir::value *neg;  // d < 0, or nullptr if d is known to be non-negative
+    ir::value *inv;  // floor(2^32 / |d|), possibly off by one
+  };
+
+private:
+  bool is_nonneg(ir::value *v, uint64_t &max, std::map<ir::value*, uint64_t> &cache);
+  bool get_inverse(ir::value *d, inverse_t &inv, ir::builder &builder);
+  bool rewrite_div_rem(ir::instruction *i, ir::builder &builder);
+  bool rewrite_iv_mul(ir::basic_block *loop, ir::builder &builder);
+
+public:
+  strength_reduction(): num_div_rem_(0), num_iv_mul_(0) {}
+  void run(ir::module &mod);
+  // statistics, accumulated over all runs
+  unsigned num_div_rem() const { return num_div_rem_; }
+  unsigned num_iv_mul() const { return num_iv_mul_; }
+
+private:
+  std::map<ir::value*, inverse_t> inverses_;
+  unsigned num_div_rem_;
+  unsigned num_iv_mul_;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_UNROLL_H
+#define TRITON_INCLUDE_IR_CODEGEN_UNROLL_H
+
+#include <map>
+#include <cstdint>
+
+namespace triton {
+
+// forward declaration
+namespace ir {
+class module;
+class value;
+class basic_block;
+class builder;
+}
+
+namespace codegen{
+namespace transform{
+
+// Unrolls single-block loops whose trip count is known at compile-time.
+// Loops are fully unrolled when (trip count) x (body size) fits in
+// `max_size` instructions, and partially unrolled by the largest factor
+// that divides the trip count and fits in `max_size` otherwise.
+// Loops containing dots or loads that the pipeline pass can prefetch are
+// left untouched. Clean-up of the unrolled code is left to dce/peephole.
+class unroll {
+  typedef std::map<ir::value*, int64_t> env_t;
+
+private:
+  bool evaluate(ir::value *v, env_t &env, int64_t &result);
+  int trip_count(ir::basic_block *loop, ir::basic_block *header, int max_trips);
+  void full_unroll(ir::basic_block *loop, ir::basic_block *header, ir::basic_block *exit, int num_trips, ir::builder &builder);
+  void partial_unroll(ir::basic_block *loop, ir::basic_block *exit, int factor, ir::builder &builder);
+  bool run(ir::basic_block *loop, ir::builder &builder);
+
+public:
+  unroll(unsigned max_size = 128, int max_trips = 4096)
+    : max_size_(max_size), max_trips_(max_trips), num_unrolled_loops_(0) {}
+  void run(ir::module &mod);
+  unsigned num_unrolled_loops() const { return num_unrolled_loops_; }
+
+private:
+  unsigned max_size_;
+  int max_trips_;
+  unsigned num_unrolled_loops_;
+};
+
+}
+}
+}
+
+#endif
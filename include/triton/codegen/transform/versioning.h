@@ -0,0 +1,53 @@
+#ifndef TRITON_INCLUDE_IR_CODEGEN_VERSIONING_H
+#define TRITON_INCLUDE_IR_CODEGEN_VERSIONING_H
+
+#include <map>
+#include <vector>
+
+namespace triton {
+
+// forward declaration
+namespace ir {
+class module;
+class value;
+class basic_block;
+class instruction;
+class builder;
+}
+
+namespace codegen{
+namespace transform{
+
+// Splits single-block loops whose masked loads/stores are guarded by
+// masks that only depend on induction variables into:
+//   - an unmasked main loop, entered/continued only when every such mask
+//     is provably all-true for the upcoming iteration;
+//   - the original (masked) loop, which handles the remaining iterations.
+class versioning {
+  typedef std::map<ir::value*, ir::value*> remap_t;
+
+private:
+  bool is_invariant(ir::value *v, ir::basic_block *loop);
+  bool depends_on_loop(ir::value *v, ir::basic_block *loop);
+  bool can_bound(ir::value *v, ir::basic_block *loop);
+  bool can_version(ir::value *mask, ir::basic_block *loop);
+  ir::value* rematerialize(ir::value *v, ir::basic_block *loop, remap_t &remap, ir::builder &builder);
+  ir::value* bound(ir::value *v, bool is_max, ir::basic_block *loop, remap_t &remap, ir::builder &builder);
+  ir::value* all_true(ir::value *mask, ir::basic_block *loop, remap_t &remap, ir::builder &builder);
+  ir::value* all_true(const std::vector<ir::value*> &masks, ir::basic_block *loop, remap_t &remap, ir::builder &builder);
+  bool run(ir::basic_block *loop, ir::builder &builder);
+
+public:
+  versioning(): num_versioned_loops_(0) {}
+  void run(ir::module &mod);
+  unsigned num_versioned_loops() const { return num_versioned_loops_; }
+
+private:
+  unsigned num_versioned_loops_;
+};
+
+}
+}
+}
+
+#endif
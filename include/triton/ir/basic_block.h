@@ -27,7 +27,7 @@ public:
 
 private:
   // constructors
-  basic_block(context &ctx, const std::string &name, function *parent);
+  basic_block(context &ctx, const std::string &name, function *parent, basic_block *next);
 
 public:
   // accessors
@@ -63,9 +63,11 @@ public:
   const std::vector<basic_block*>& get_predecessors() const { return preds_; }
   const std::vector<basic_block*>& get_successors() const { return succs_; }
   void add_predecessor(basic_block* pred);
+  void replace_predecessor(basic_block* before, basic_block* after);
+  void remove_predecessor(basic_block* pred);
 
   // factory functions
-  static basic_block* create(context &ctx, const std::string &name, function *parent);
+  static basic_block* create(context &ctx, const std::string &name, function *parent, basic_block *next = nullptr);
 
   // visitor
   void accept(visitor *v) { v->visit_basic_block(this); }
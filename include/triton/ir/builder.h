@@ -130,10 +130,18 @@ public:
   value *create_xor(value *lhs, value *rhs);
   value *create_or(value *lhs, value *rhs);
   // Input/Output
-  value *create_load(value *arg);
-  value *create_store(value *ptr, value *val);
-  value *create_masked_load(value *arg, value *mask, value *false_value);
-  value *create_masked_store(value *ptr, value *val, value *mask);
+  value *create_load(value *arg,
+                     io_inst::CACHE_MODIFIER cache = io_inst::NONE,
+                     io_inst::EVICTION_POLICY eviction = io_inst::NORMAL);
+  value *create_store(value *ptr, value *val,
+                      io_inst::CACHE_MODIFIER cache = io_inst::NONE,
+                      io_inst::EVICTION_POLICY eviction = io_inst::NORMAL);
+  value *create_masked_load(value *arg, value *mask, value *false_value,
+                            io_inst::CACHE_MODIFIER cache = io_inst::NONE,
+                            io_inst::EVICTION_POLICY eviction = io_inst::NORMAL);
+  value *create_masked_store(value *ptr, value *val, value *mask,
+                             io_inst::CACHE_MODIFIER cache = io_inst::NONE,
+                             io_inst::EVICTION_POLICY eviction = io_inst::NORMAL);
   // Block instruction
   value *create_splat(value *arg, const type::block_shapes_t &shapes);
   value *create_reshape(value *arg, const type::block_shapes_t &shapes);
@@ -148,14 +156,23 @@ public:
   value *create_cos(value* arg);
   value *create_sin(value* arg);
   value *create_log(value* arg);
-  value *create_dot(value *A, value *B, value *C);
+  value *create_exp2(value* arg, bool approx);
+  value *create_tanh(value* arg, bool approx);
+  value *create_erf(value* arg, bool approx);
+  value *create_sigmoid(value* arg, bool approx);
+  value *create_rsqrt(value* arg, bool approx);
+  value *create_pow(value* x, value* y, bool approx);
+  value *create_dot(value *A, value *B, value *C, bool allow_tf32 = false);
   value *create_trans(value *A, const std::vector<int> &perm = {});
   value *create_sqrt(value *A);
   value *create_reduce(value *A, reduce_inst::op_t op, unsigned axis);
+  value *create_scan(value *A, scan_inst::op_t op, unsigned axis, bool exclusive);
   value *create_select(value *pred, value *if_value, value *else_value);
   // Intrinsics
   value *create_copy_to_shared(value *arg);
-  value *create_masked_load_async(value *arg, value *mask, value *false_value);
+  value *create_masked_load_async(value *arg, value *mask, value *false_value,
+                                  io_inst::CACHE_MODIFIER cache = io_inst::NONE,
+                                  io_inst::EVICTION_POLICY eviction = io_inst::NORMAL);
   value *create_copy_from_shared(value *arg);
   value *create_barrier(const std::string &name = "");
   value *create_async_wait(int N);
@@ -145,9 +145,16 @@ enum value_id_t: unsigned {
   INST_COS,
   INST_SIN,
   INST_LOG,
+  INST_EXP2,
+  INST_TANH,
+  INST_ERF,
+  INST_SIGMOID,
+  INST_RSQRT,
+  INST_POW,
   // array arithmetic
   INST_TRANS,
   INST_REDUCE,
+  INST_SCAN,
   INST_DOT,
   // intrinsics
   INST_COPY_TO_SHARED,
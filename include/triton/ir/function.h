@@ -111,6 +111,7 @@ public:
   // blocks
   const blocks_t &blocks() { return blocks_; }
   void insert_block(basic_block* block, basic_block *next = nullptr);
+  void erase_block(basic_block* block);
 
   // attributes
   void add_attr(unsigned arg_id, attribute attr) { attrs_[arg_id].insert(attr); }
@@ -381,6 +381,24 @@ private:
 //===----------------------------------------------------------------------===//
 
 class io_inst: public instruction {
+public:
+  // cache operators of global memory accesses
+  enum CACHE_MODIFIER {
+    NONE = 0,
+    CA,  // cache at all levels (loads)
+    CG,  // cache in L2 only
+    CS,  // streaming, likely accessed once
+    LU,  // last use (loads)
+    WB,  // write-back (stores)
+    WT   // write-through to system memory (stores)
+  };
+  // L2 eviction priority (sm80+)
+  enum EVICTION_POLICY {
+    NORMAL = 0,
+    EVICT_FIRST,
+    EVICT_LAST
+  };
+
 protected:
   io_inst(type *ty, value_id_t id, unsigned num_ops,
           const std::string &name = "", instruction *next = nullptr);
@@ -388,6 +406,16 @@ protected:
 public:
   // accessors
   value *get_pointer_operand() { return get_operand(0); }
+  CACHE_MODIFIER get_cache_modifier() const { return cache_modifier_; }
+  EVICTION_POLICY get_eviction_policy() const { return eviction_policy_; }
+  void set_cache_hints(CACHE_MODIFIER modifier, EVICTION_POLICY policy) {
+    cache_modifier_ = modifier;
+    eviction_policy_ = policy;
+  }
+
+private:
+  CACHE_MODIFIER cache_modifier_;
+  EVICTION_POLICY eviction_policy_;
 };
 
 // load
@@ -690,6 +718,88 @@ public:
   static instruction* create(value *val, const std::string &name = "", instruction *next = nullptr);
 };
 
+// transcendental functions with two accuracy tiers:
+//  - approx == false: accurate to a few ulps (see generator.cc)
+//  - approx == true: built on the PTX *.approx instructions
+class math_inst: public builtin_inst {
+protected:
+  math_inst(type *ty, value_id_t id, unsigned num_ops, bool approx, const std::string &name, instruction *next)
+    : builtin_inst(ty, id, num_ops, name, next), approx_(approx) { }
+  std::string repr_suffix() const { return approx_ ? ".approx" : ""; }
+
+public:
+  bool is_approx() const { return approx_; }
+
+private:
+  bool approx_;
+};
+
+class exp2_inst: public math_inst {
+private:
+  exp2_inst(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "exp2" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(exp2_inst)
+  _TRITON_DEFINE_ACCEPT(exp2_inst)
+
+public:
+  static instruction* create(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
+class tanh_inst: public math_inst {
+private:
+  tanh_inst(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "tanh" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(tanh_inst)
+  _TRITON_DEFINE_ACCEPT(tanh_inst)
+
+public:
+  static instruction* create(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
+class erf_inst: public math_inst {
+private:
+  erf_inst(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "erf" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(erf_inst)
+  _TRITON_DEFINE_ACCEPT(erf_inst)
+
+public:
+  static instruction* create(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
+class sigmoid_inst: public math_inst {
+private:
+  sigmoid_inst(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "sigmoid" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(sigmoid_inst)
+  _TRITON_DEFINE_ACCEPT(sigmoid_inst)
+
+public:
+  static instruction* create(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
+class rsqrt_inst: public math_inst {
+private:
+  rsqrt_inst(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "rsqrt" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(rsqrt_inst)
+  _TRITON_DEFINE_ACCEPT(rsqrt_inst)
+
+public:
+  static instruction* create(value *val, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
+class pow_inst: public math_inst {
+private:
+  pow_inst(value *x, value *y, bool approx, const std::string &name = "", instruction *next = nullptr);
+  std::string repr_impl() const { return "pow" + repr_suffix(); }
+  _TRITON_DEFINE_CLONE(pow_inst)
+  _TRITON_DEFINE_ACCEPT(pow_inst)
+
+public:
+  static instruction* create(value *x, value *y, bool approx, const std::string &name = "", instruction *next = nullptr);
+};
+
 
 class dot_inst: public builtin_inst {
 public:
@@ -700,9 +810,13 @@ private:
   std::string repr_impl() const { return "dot"; }
 
   bool is_prefetched_ = false;
+  bool allow_tf32_ = false;
 public:
   bool is_prefetched() const { return is_prefetched_; }
   void set_prefetched(bool is_prefetched) { is_prefetched_ = is_prefetched; }
+  // fp32 operands may be rounded to tf32 to use tensor cores
+  bool allow_tf32() const { return allow_tf32_; }
+  void set_allow_tf32(bool allow_tf32) { allow_tf32_ = allow_tf32; }
 
 public:
   static instruction *create(value *A, value *B, value *C, bool AT, bool BT, const std::string &name = "", instruction *next = nullptr);
@@ -754,11 +868,13 @@ class reduce_inst: public builtin_inst {
 public:
   enum op_t{
     ADD, SUB, MAX, MIN,
-    FADD, FSUB, FMAX, FMIN
+    FADD, FSUB, FMAX, FMIN,
+    // position of the extremum along `axis`, as int32
+    ARGMAX, ARGMIN, ARGFMAX, ARGFMIN
   };
 
 private:
-  static type* get_res_type(value *arg, unsigned axis);
+  static type* get_res_type(value *arg, op_t op, unsigned axis);
   static std::string to_str(op_t op);
 
 private:
@@ -771,10 +887,38 @@ public:
   static instruction* create(value *arg, op_t op, unsigned axis, const std::string &name = "", instruction *next = nullptr);
   unsigned get_axis() const { return axis_; }
   op_t get_op() const { return op_; }
+  bool with_index() const { return op_ == ARGMAX || op_ == ARGMIN || op_ == ARGFMAX || op_ == ARGFMIN; }
+
+private:
+  unsigned axis_;
+  op_t op_;
+};
+
+// prefix reduction along `axis`. The exclusive variant yields the
+// identity of `op` for the first element
+class scan_inst: public builtin_inst {
+public:
+  enum op_t{
+    ADD, MAX, MIN,
+    FADD, FMAX, FMIN
+  };
+
+private:
+  scan_inst(value* arg, op_t op, unsigned axis, bool exclusive, const std::string& name, instruction* next);
+  std::string repr_impl() const { return exclusive_ ? "exclusive_scan" : "scan"; }
+  _TRITON_DEFINE_CLONE(scan_inst)
+  _TRITON_DEFINE_ACCEPT(scan_inst)
+
+public:
+  static instruction* create(value *arg, op_t op, unsigned axis, bool exclusive, const std::string &name = "", instruction *next = nullptr);
+  unsigned get_axis() const { return axis_; }
+  op_t get_op() const { return op_; }
+  bool is_exclusive() const { return exclusive_; }
 
 private:
   unsigned axis_;
   op_t op_;
+  bool exclusive_;
 };
 
 class select_inst: public builtin_inst {
@@ -4,6 +4,7 @@
 #define _TRITON_IR_CFG_H_
 
 #include <vector>
+#include <map>
 #include <functional>
 
 namespace triton{
@@ -19,6 +20,8 @@ class cfg {
 public:
   static std::vector<basic_block *> post_order(function* fn);
   static std::vector<basic_block *> reverse_post_order(function* fn);
+  // nullptr stands for the virtual exit node, blocks that cannot reach an exit are left out
+  static std::map<basic_block *, basic_block *> immediate_post_dominators(function* fn);
 };
 
 void for_each_instruction(ir::module& mod, const std::function<void(triton::ir::instruction*)> &fn);
@@ -49,6 +49,17 @@ inline T add_to_cache(ir::value *i, T value, std::map<ir::value*, T> &map) {
   return map[i] = value;
 }
 
+// Loop-carried phis are analyzed under the assumption that they are as good
+// as their value on loop entry. When the loop turns out to be worse, the
+// weaker result becomes the new assumption and the module is analyzed again.
+template<class T>
+inline bool weaken(ir::value *i, const T& assumed, const T& value, std::map<ir::value*, T> &assumptions) {
+  if(value == assumed)
+    return false;
+  assumptions[i] = value;
+  return true;
+}
+
 /*
  * is constant
  */
@@ -61,23 +72,51 @@ std::vector<unsigned> align::get_shapes(ir::value *v) {
     return {1};
 }
 
+// number of consecutive elements that a select takes from the same operand
+std::vector<unsigned> align::pred_constancy(ir::select_inst *x) {
+  auto shapes = get_shapes(x);
+  ir::value *pred = x->get_pred_op();
+  if(!pred->get_type()->is_block_ty())
+    return shapes;
+  std::vector<unsigned> result;
+  for(const cst_info& c: populate_is_constant(pred))
+    result.push_back(c.num_cst);
+  return result;
+}
+
+// largest known divisor of every element of `v`: elements along axes where
+// it is not contiguous each start a block
+unsigned align::element_multiple(ir::value *v) {
+  auto sm = populate_starting_multiple(v);
+  auto mc = populate_max_contiguous(v);
+  unsigned result = 1;
+  for(size_t d = 0; d < sm.size(); d++)
+    if(mc[d] == 1)
+      result = std::max(result, sm[d]);
+  return result;
+}
+
 std::vector<align::cst_info> align::populate_is_constant_phi(ir::phi_node* x) {
   auto shapes = get_shapes(x);
   std::vector<cst_info> result(shapes.size(), cst_info{1, 0});
-  for(unsigned n = 0; n < x->get_num_incoming(); n++){
-    ir::value* inc = x->get_incoming_value(n);
-    auto it = is_constant_.find(inc);
-    if(it != is_constant_.end())
-      result = it->second;
-  }
-  return add_to_cache(x, result, is_constant_);
+  add_to_cache(x, result, is_constant_);
+  if(assumed_is_constant_.find(x) != assumed_is_constant_.end())
+    result = assumed_is_constant_.at(x);
+  else
+    result = populate_is_constant(x->get_incoming_value(0));
+  add_to_cache(x, result, is_constant_);
+  auto assumed = result;
   // recurse
   for(unsigned n = 0; n < x->get_num_incoming(); n++){
     ir::value* inc = x->get_incoming_value(n);
     auto cst = populate_is_constant(inc);
-    for(size_t d = 0; d < cst.size(); d++)
+    for(size_t d = 0; d < cst.size(); d++){
       result[d].num_cst = std::min(result[d].num_cst, cst[d].num_cst);
+      if(result[d].value != cst[d].value)
+        result[d].value = 0;
+    }
   }
+  changed_ |= weaken(x, assumed, result, assumed_is_constant_);
   return add_to_cache(x, result, is_constant_);
 }
 
@@ -137,15 +176,17 @@ std::vector<align::cst_info> align::populate_is_constant_binop(ir::binary_operat
   auto lhs = populate_is_constant(lhs_op);
   auto rhs = populate_is_constant(rhs_op);
   auto max_contiguous = populate_max_contiguous(lhs_op);
+  auto lhs_starting_multiple = populate_starting_multiple(lhs_op);
+  auto rhs_starting_multiple = populate_starting_multiple(rhs_op);
   for(size_t d = 0; d < x_shapes.size(); d++) {
-    cst_info ax;
-    if(lhs[d].num_cst==0 && rhs[d].value && x->is_int_div()){
-      // todo might not be entirely true
-      unsigned num_constants = gcd(max_contiguous[d], rhs[d].value);
-      ax = {num_constants, 0};
+    cst_info ax = {std::min(lhs[d].num_cst, rhs[d].num_cst), 0};
+    if(x->is_int_div() && rhs_starting_multiple[d] > 0){
+      // k contiguous values starting at a multiple of k, divided by the
+      // same multiple of k, all have the same quotient
+      unsigned num_constants = gcd(max_contiguous[d], gcd(lhs_starting_multiple[d], rhs_starting_multiple[d]));
+      num_constants = std::min(num_constants, rhs[d].num_cst);
+      ax.num_cst = std::max(ax.num_cst, num_constants);
     }
-    else
-      ax = {std::min(lhs[d].num_cst, rhs[d].num_cst), 0};
     result.push_back(ax);
   }
   return add_to_cache(x, result, is_constant_);
@@ -163,6 +204,47 @@ std::vector<align::cst_info> align::populate_is_constant_gep(ir::getelementptr_i
   return add_to_cache(x, result, is_constant_);
 }
 
+std::vector<align::cst_info> align::populate_is_constant_cmp(ir::cmp_inst* x) {
+  auto x_shapes = get_shapes(x);
+  ir::value* lhs_op = x->get_operand(0);
+  ir::value* rhs_op = x->get_operand(1);
+  auto lhs = populate_is_constant(lhs_op);
+  auto rhs = populate_is_constant(rhs_op);
+  auto lhs_max_contiguous = populate_max_contiguous(lhs_op);
+  auto lhs_starting_multiple = populate_starting_multiple(lhs_op);
+  auto rhs_starting_multiple = populate_starting_multiple(rhs_op);
+  ir::cmp_pred_t pred = x->get_pred();
+  bool is_lt_ge = pred == ir::cmp_pred_t::ICMP_SLT || pred == ir::cmp_pred_t::ICMP_ULT ||
+                  pred == ir::cmp_pred_t::ICMP_SGE || pred == ir::cmp_pred_t::ICMP_UGE;
+  std::vector<cst_info> result;
+  for(size_t d = 0; d < x_shapes.size(); d++){
+    cst_info ax = {std::min(lhs[d].num_cst, rhs[d].num_cst), 0};
+    // aligned blocks of k contiguous values are either all below or all
+    // above a bound that is a multiple of k, e.g. a mask `idx < N`
+    if(is_lt_ge){
+      unsigned num_constants = gcd(lhs_max_contiguous[d], gcd(lhs_starting_multiple[d], rhs_starting_multiple[d]));
+      num_constants = std::min(num_constants, rhs[d].num_cst);
+      ax.num_cst = std::max(ax.num_cst, num_constants);
+    }
+    result.push_back(ax);
+  }
+  return add_to_cache(x, result, is_constant_);
+}
+
+std::vector<align::cst_info> align::populate_is_constant_select(ir::select_inst* x) {
+  auto x_shapes = get_shapes(x);
+  auto pred = pred_constancy(x);
+  auto if_value = populate_is_constant(x->get_if_value_op());
+  auto else_value = populate_is_constant(x->get_else_value_op());
+  std::vector<cst_info> result;
+  for(size_t d = 0; d < x_shapes.size(); d++){
+    unsigned num_cst = std::min(pred[d], std::min(if_value[d].num_cst, else_value[d].num_cst));
+    unsigned value = if_value[d].value == else_value[d].value ? if_value[d].value : 0;
+    result.push_back({num_cst, value});
+  }
+  return add_to_cache(x, result, is_constant_);
+}
+
 std::vector<align::cst_info> align::populate_is_constant_default(ir::value *v) {
   auto shapes = get_shapes(v);
   std::vector<cst_info> result(shapes.size(), {1, 0});
@@ -186,6 +268,10 @@ std::vector<align::cst_info> align::populate_is_constant(ir::value *v) {
     return populate_is_constant_binop(x);
   if(auto *x = dynamic_cast<ir::getelementptr_inst*>(v))
     return populate_is_constant_gep(x);
+  if(auto *x = dynamic_cast<ir::cmp_inst*>(v))
+    return populate_is_constant_cmp(x);
+  if(auto *x = dynamic_cast<ir::select_inst*>(v))
+    return populate_is_constant_select(x);
   return populate_is_constant_default(v);
 }
 
@@ -197,13 +283,13 @@ std::vector<align::cst_info> align::populate_is_constant(ir::value *v) {
 std::vector<unsigned> align::populate_max_contiguous_phi(ir::phi_node* x) {
   auto shapes = get_shapes(x);
   std::vector<unsigned> result(shapes.size(), 1);
-  for(unsigned n = 0; n < x->get_num_incoming(); n++){
-    ir::value* inc = x->get_incoming_value(n);
-    auto it = max_contiguous_.find(inc);
-    if(it != max_contiguous_.end())
-      result = it->second;
-  }
   add_to_cache(x, result, max_contiguous_);
+  if(assumed_max_contiguous_.find(x) != assumed_max_contiguous_.end())
+    result = assumed_max_contiguous_.at(x);
+  else
+    result = populate_max_contiguous(x->get_incoming_value(0));
+  add_to_cache(x, result, max_contiguous_);
+  auto assumed = result;
   // recurse
   for(unsigned n = 0; n < x->get_num_incoming(); n++){
     ir::value* inc = x->get_incoming_value(n);
@@ -211,8 +297,8 @@ std::vector<unsigned> align::populate_max_contiguous_phi(ir::phi_node* x) {
     for(size_t d = 0; d < result.size(); d++)
       result[d] = std::min(result[d], contiguous[d]);
   }
+  changed_ |= weaken(x, assumed, result, assumed_max_contiguous_);
   return add_to_cache(x, result, max_contiguous_);
-
 }
 
 std::vector<unsigned> align::populate_max_contiguous_splat(ir::splat_inst* x) {
@@ -273,7 +359,9 @@ std::vector<unsigned> align::populate_max_contiguous_binop(ir::binary_operator*
   for(size_t d = 0; d < shapes.size(); d++){
     unsigned value = 1;
     if(x->is_int_rem() && rhs_starting_multiple[d] > 0){
-      value = std::min(lhs_max_contiguous[d], rhs_starting_multiple[d]);
+      // contiguous values only wrap around at multiples of the divisor
+      value = gcd(lhs_max_contiguous[d], gcd(lhs_starting_multiple[d], rhs_starting_multiple[d]));
+      value = std::min(value, rhs_cst_info[d].num_cst);
     }
     if(x->is_int_mult()){
       unsigned lvalue = 1, rvalue = 1;
@@ -287,6 +375,11 @@ std::vector<unsigned> align::populate_max_contiguous_binop(ir::binary_operator*
       unsigned lvalue = 1, rvalue = 1;
       lvalue = gcd(rhs_max_contiguous[d], lhs_starting_multiple[d]);
       rvalue = gcd(lhs_max_contiguous[d], rhs_starting_multiple[d]);
+      // offsetting contiguous values by a value that is constant over them,
+      // e.g. a broadcast row offset
+      if(x->get_op() == ir::binary_op_t::Add)
+        lvalue = std::max<unsigned>(lvalue, gcd(rhs_max_contiguous[d], lhs_cst_info[d].num_cst));
+      rvalue = std::max<unsigned>(rvalue, gcd(lhs_max_contiguous[d], rhs_cst_info[d].num_cst));
       value = std::max(lvalue, rvalue);
     }
     result.push_back(value);
@@ -304,16 +397,24 @@ std::vector<unsigned> align::populate_max_contiguous_gep(ir::getelementptr_inst*
   auto rhs_cst_info = populate_is_constant(rhs);
   std::vector<unsigned> result(shapes.size(), 1);
   for(size_t d = 0; d < shapes.size(); d++){
-    unsigned lvalue = 1, rvalue = 1;
-    if(lhs_cst_info[d].num_cst)
-      lvalue = rhs_max_contiguous[d];
-    if(rhs_cst_info[d].num_cst)
-      rvalue = lhs_max_contiguous[d];
+    unsigned lvalue = gcd(rhs_max_contiguous[d], lhs_cst_info[d].num_cst);
+    unsigned rvalue = gcd(lhs_max_contiguous[d], rhs_cst_info[d].num_cst);
     result[d] = std::max(lvalue, rvalue);
   }
   return add_to_cache(x, result, max_contiguous_);
 }
 
+std::vector<unsigned> align::populate_max_contiguous_select(ir::select_inst* x) {
+  auto shapes = get_shapes(x);
+  auto pred = pred_constancy(x);
+  auto if_value = populate_max_contiguous(x->get_if_value_op());
+  auto else_value = populate_max_contiguous(x->get_else_value_op());
+  std::vector<unsigned> result;
+  for(size_t d = 0; d < shapes.size(); d++)
+    result.push_back(gcd(pred[d], gcd(if_value[d], else_value[d])));
+  return add_to_cache(x, result, max_contiguous_);
+}
+
 std::vector<unsigned> align::populate_max_contiguous_default(ir::value* v) {
   if(!v->get_type()->is_block_ty())
     return add_to_cache(v, {1}, max_contiguous_);
@@ -345,6 +446,8 @@ std::vector<unsigned> align::populate_max_contiguous(ir::value *v){
     return populate_max_contiguous_gep(x);
   if(auto *x = dynamic_cast<ir::phi_node*>(v))
     return populate_max_contiguous_phi(x);
+  if(auto *x = dynamic_cast<ir::select_inst*>(v))
+    return populate_max_contiguous_select(x);
   return populate_max_contiguous_default(v);
 }
 
@@ -365,11 +468,14 @@ std::vector<unsigned> align::populate_starting_multiple_reshape(ir::reshape_inst
   auto op_shapes = get_shapes(x->get_operand(0));
   auto shapes = get_shapes(x);
   std::vector<unsigned> result(shapes.size(), 1);
+  // elements along unit axes start blocks of their own, and are multiples
+  // of whatever every element of the operand is a multiple of
+  unsigned elt_multiple = element_multiple(x->get_operand(0));
   unsigned current = 0;
   bool is_skewed = false;
   for(size_t d = 0; d < shapes.size(); d ++){
     if(shapes[d] == 1)
-      result[d] = 1;
+      result[d] = elt_multiple;
     else if(!is_skewed
             && shapes[d] == op_shapes[current])
       result[d] = op[current++];
@@ -389,10 +495,21 @@ std::vector<unsigned> align::populate_starting_multiple_broadcast(ir::broadcast_
 std::vector<unsigned> align::populate_starting_multiple_binop(ir::binary_operator* x){
   auto lhs = populate_starting_multiple(x->get_operand(0));
   auto rhs = populate_starting_multiple(x->get_operand(1));
+  auto lhs_mc = populate_max_contiguous(x->get_operand(0));
+  auto rhs_mc = populate_max_contiguous(x->get_operand(1));
+  auto lhs_cst = populate_is_constant(x->get_operand(0));
+  auto rhs_cst = populate_is_constant(x->get_operand(1));
+  // products of contiguous values are only multiples of the other operand,
+  // unless it is 1 and blocks are preserved
+  std::vector<unsigned> lhs_elt(lhs.size()), rhs_elt(rhs.size());
+  for(size_t d = 0; d < lhs.size(); d++){
+    lhs_elt[d] = lhs_mc[d] == 1 || rhs_cst[d].value == 1 ? lhs[d] : 1;
+    rhs_elt[d] = rhs_mc[d] == 1 || lhs_cst[d].value == 1 ? rhs[d] : 1;
+  }
   std::vector<unsigned> result(lhs.size(), 1);
   for(size_t d = 0; d < lhs.size(); d++){
     if(x->is_int_mult())
-      result[d] = lhs[d] * rhs[d];
+      result[d] = lhs_elt[d] * rhs_elt[d];
     if(x->is_int_add_sub())
       result[d] = gcd(lhs[d], rhs[d]);
     if(x->is_int_div())
@@ -422,12 +539,13 @@ std::vector<unsigned> align::populate_starting_multiple_gep(ir::getelementptr_in
 std::vector<unsigned> align::populate_starting_multiple_phi(ir::phi_node* x){
   auto shape = get_shapes(x);
   std::vector<unsigned> result(shape.size(), 1);
-  for(unsigned n = 0; n < x->get_num_incoming(); n++){
-    ir::value* inc = x->get_incoming_value(n);
-    if(starting_multiple_.find(inc) != starting_multiple_.end())
-      result = starting_multiple_.at(inc);
-  }
   add_to_cache(x, result, starting_multiple_);
+  if(assumed_starting_multiple_.find(x) != assumed_starting_multiple_.end())
+    result = assumed_starting_multiple_.at(x);
+  else
+    result = populate_starting_multiple(x->get_incoming_value(0));
+  add_to_cache(x, result, starting_multiple_);
+  auto assumed = result;
   // recurse
   for(unsigned n = 0; n < x->get_num_incoming(); n++){
     ir::value* inc = x->get_incoming_value(n);
@@ -435,10 +553,20 @@ std::vector<unsigned> align::populate_starting_multiple_phi(ir::phi_node* x){
     for(size_t d = 0; d < result.size(); d++)
       result[d] = gcd(result[d], sm[d]);
   }
+  changed_ |= weaken(x, assumed, result, assumed_starting_multiple_);
   return add_to_cache(x, result, starting_multiple_);
 }
 
 
+std::vector<unsigned> align::populate_starting_multiple_select(ir::select_inst* x){
+  auto if_value = populate_starting_multiple(x->get_if_value_op());
+  auto else_value = populate_starting_multiple(x->get_else_value_op());
+  std::vector<unsigned> result(if_value.size(), 1);
+  for(size_t d = 0; d < result.size(); d++)
+    result[d] = gcd(if_value[d], else_value[d]);
+  return add_to_cache(x, result, starting_multiple_);
+}
+
 std::vector<unsigned> align::populate_starting_multiple_cast(ir::cast_inst* x){
   auto result = populate_starting_multiple(x->get_operand(0));
   return add_to_cache(x, result, starting_multiple_);
@@ -492,6 +620,8 @@ std::vector<unsigned> align::populate_starting_multiple(ir::value *v){
     return populate_starting_multiple_broadcast(x);
   if(auto *x = dynamic_cast<ir::phi_node*>(v))
     return populate_starting_multiple_phi(x);
+  if(auto *x = dynamic_cast<ir::select_inst*>(v))
+    return populate_starting_multiple_select(x);
   return populate_starting_multiple_default(v);
 }
 
@@ -506,6 +636,13 @@ std::vector<unsigned> align::contiguous(ir::value* v) const {
   return max_contiguous_.at(v);
 }
 
+std::vector<unsigned> align::constancy(ir::value* v) const {
+  std::vector<unsigned> result;
+  for(const cst_info& x: is_constant_.at(v))
+    result.push_back(x.num_cst);
+  return result;
+}
+
 
 void align::populate(ir::value *v) {
   populate_is_constant(v);
@@ -515,7 +652,16 @@ void align::populate(ir::value *v) {
 }
 
 void align::run(ir::module &mod) {
-  ir::for_each_value(mod, [this](ir::value* v) { populate(v); } );
+  assumed_is_constant_.clear();
+  assumed_max_contiguous_.clear();
+  assumed_starting_multiple_.clear();
+  do {
+    changed_ = false;
+    is_constant_.clear();
+    max_contiguous_.clear();
+    starting_multiple_.clear();
+    ir::for_each_value(mod, [this](ir::value* v) { populate(v); } );
+  } while(changed_);
 //  ir::for_each_value(mod, [this](ir::value* v) {
 //      if(dynamic_cast<ir::cast_inst*>(v) || dynamic_cast<ir::getelementptr_inst*>(v))
 //        std::cout << "ALIGN: " << v->get_name() << " " << max_contiguous_.at(v)[0] << " " << max_contiguous_.at(v)[1] << std::endl;
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <climits>
+#include <functional>
 #include "triton/codegen/analysis/layout.h"
 #include "triton/codegen/analysis/allocation.h"
 #include "triton/codegen/analysis/liveness.h"
@@ -9,97 +10,127 @@ namespace triton{
 namespace codegen{
 namespace analysis{
 
-
-void allocation::run(ir::module &mod) {
-  using std::max;
-  using std::min;
-  typedef std::multimap<unsigned, segment> triples_map_type;
-
-  std::vector<shared_layout*> I;
-  for(auto x: liveness_->get())
-    I.push_back(x.first);
-  std::vector<shared_layout*> J = I;
-
-  triples_map_type H;
-  H.insert({0, segment{0, INT_MAX}});
-
-  std::vector<shared_layout*> V;
-  std::map<shared_layout*, unsigned> starts;
-  while(!J.empty()){
-    auto h_it = H.begin();
-    unsigned w = h_it->first;
-    segment xh = h_it->second;
-    H.erase(h_it);
-    auto j_it = std::find_if(J.begin(), J.end(), [&](shared_layout* JJ){
-      segment xj = liveness_->get(JJ);
-      bool res = xj.intersect(xh);
-      for(auto val: H)
-        res = res && !val.second.intersect(xj);
-      return res;
-    });
-    if(j_it != J.end()){
-      unsigned size = (*j_it)->get_size();
-      segment xj = liveness_->get(*j_it);
-      starts[*j_it] = w;
-      H.insert({w + size, segment{max(xh.start, xj.start), min(xh.end, xj.end)}});
-      if(xh.start < xj.start)
-        H.insert({w, segment{xh.start, xj.end}});
-      if(xj.end < xh.end)
-        H.insert({w, segment{xj.start, xh.end}});
-      V.push_back(*j_it);
-      J.erase(j_it);
+// Places each buffer in the smallest gap between the buffers it interferes
+// with that have already been placed, or on top of them if none fits
+size_t allocation::best_fit(const std::vector<shared_layout*>& V, const interferences_t& interferences, offsets_t& offsets) {
+  auto align = [&](size_t x) { return (x + alignment_ - 1) / alignment_ * alignment_; };
+  size_t extent = 0;
+  for(shared_layout* x: V){
+    size_t size = x->get_size();
+    std::vector<std::pair<size_t, size_t>> used;
+    for(shared_layout* y: interferences.at(x))
+      if(offsets.count(y))
+        used.push_back({offsets.at(y), offsets.at(y) + y->get_size()});
+    std::sort(used.begin(), used.end());
+    size_t best = SIZE_MAX;
+    size_t best_gap = SIZE_MAX;
+    size_t cursor = 0;
+    for(auto& u: used){
+      size_t start = align(cursor);
+      if(start + size <= u.first && u.first - start < best_gap){
+        best = start;
+        best_gap = u.first - start;
+      }
+      cursor = std::max(cursor, u.second);
     }
+    if(best == SIZE_MAX)
+      best = align(cursor);
+    offsets[x] = best;
+    extent = std::max(extent, best + size);
   }
+  return extent;
+}
 
-  // Build interference graph
-  std::map<shared_layout*, std::set<shared_layout*>> interferences;
-  for(shared_layout* x: V)
-  for(shared_layout* y: V){
-    if(x == y)
-      continue;
-    unsigned X0 = starts[x], Y0 = starts[y];
-    unsigned NX = x->get_size();
-    unsigned NY = y->get_size();
-    segment XS = {X0, X0 + NX};
-    segment YS = {Y0, Y0 + NY};
-    if(liveness_->get(x).intersect(liveness_->get(y))
-        && XS.intersect(YS))
-      interferences[x].insert(y);
-  }
+// Any placement can be normalized by moving each buffer down until it rests
+// at 0 or on a buffer it interferes with. Buffers are then enumerated by
+// non-decreasing offsets, each candidate offset being the (aligned) end of a
+// placed neighbor. Only placements strictly better than `bound` are kept.
+size_t allocation::exact(const std::vector<shared_layout*>& V, const interferences_t& interferences, size_t bound, offsets_t& offsets) {
+  auto align = [&](size_t x) { return (x + alignment_ - 1) / alignment_ * alignment_; };
+  size_t best = bound;
+  size_t budget = 1 << 16;
+  offsets_t current;
+  std::vector<bool> placed(V.size(), false);
+  std::function<void(size_t, size_t, size_t)> search = [&](size_t num_placed, size_t min_offset, size_t extent) {
+    if(extent >= best || budget == 0)
+      return;
+    budget--;
+    if(num_placed == V.size()){
+      best = extent;
+      offsets = current;
+      return;
+    }
+    for(size_t i = 0; i < V.size(); i++){
+      if(placed[i])
+        continue;
+      shared_layout* x = V[i];
+      size_t size = x->get_size();
+      std::set<size_t> candidates = {0};
+      for(shared_layout* y: interferences.at(x))
+        if(current.count(y))
+          candidates.insert(align(current.at(y) + y->get_size()));
+      for(size_t off: candidates){
+        if(off < min_offset)
+          continue;
+        bool fits = true;
+        for(shared_layout* y: interferences.at(x))
+          if(current.count(y) && off < current.at(y) + y->get_size() && current.at(y) < off + size)
+            fits = false;
+        if(!fits)
+          continue;
+        placed[i] = true;
+        current[x] = off;
+        search(num_placed + 1, off, std::max(extent, off + size));
+        current.erase(x);
+        placed[i] = false;
+      }
+    }
+  };
+  search(0, 0, 0);
+  return best;
+}
 
-  // Initialize colors
-  std::map<shared_layout*, int> colors;
-  for(shared_layout* X: V)
-    colors[X] = (X==V[0])?0:-1;
+void allocation::run(ir::module &mod) {
+  offsets_.clear();
 
+  // buffers, largest and longest-lived first
+  std::vector<shared_layout*> V;
+  for(auto x: liveness_->get())
+    V.push_back(x.first);
+  std::sort(V.begin(), V.end(), [&](shared_layout* x, shared_layout* y) {
+    const live_range& rx = liveness_->get(x);
+    const live_range& ry = liveness_->get(y);
+    return std::make_tuple(x->get_size(), rx.length(), ry.start()) >
+           std::make_tuple(y->get_size(), ry.length(), rx.start());
+  });
 
-  // First-fit graph coloring
-  std::vector<bool> available(V.size());
+  // Build interference graph
+  interferences_t interferences;
   for(shared_layout* x: V){
-    // Non-neighboring colors are available
-    std::fill(available.begin(), available.end(), true);
-    for(shared_layout* Y: interferences[x]){
-      int color = colors[Y];
-      if(color >= 0)
-        available[color] = false;
-    }
-    // Assigns first available color
-    auto It = std::find(available.begin(), available.end(), true);
-    colors[x] = std::distance(available.begin(), It);
+    interferences[x];
+    for(shared_layout* y: V)
+      if(x != y && liveness_->get(x).intersect(liveness_->get(y)))
+        interferences[x].push_back(y);
   }
 
-  // Finalize allocation
-  for(shared_layout* x: V){
-    unsigned Adj = 0;
-    for(shared_layout* y: interferences[x])
-      Adj = std::max<unsigned>(Adj, starts[y] + y->get_size());
-    offsets_[x] = starts[x] + colors[x] * Adj;
+  // Peak of live bytes, reached at the start of some live segment
+  peak_live_size_ = 0;
+  for(shared_layout* x: V)
+  for(const segment& s: liveness_->get(x).segments){
+    size_t live = 0;
+    for(shared_layout* y: V)
+      if(liveness_->get(y).contains(s.start))
+        live += y->get_size();
+    peak_live_size_ = std::max(peak_live_size_, live);
   }
 
-  // Save maximum size of induced memory space
-  allocated_size_ = 0;
-  for(shared_layout* x: V)
-    allocated_size_ = std::max<size_t>(allocated_size_, starts[x] + x->get_size());
+  // Place buffers
+  offsets_t offsets;
+  allocated_size_ = best_fit(V, interferences, offsets);
+  if(V.size() <= max_exact_ && allocated_size_ > peak_live_size_)
+    allocated_size_ = exact(V, interferences, allocated_size_, offsets);
+  for(auto& x: offsets)
+    offsets_[x.first] = x.second;
 }
 
 }
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <set>
+#include "triton/codegen/analysis/bank_conflicts.h"
+#include "triton/codegen/analysis/layout.h"
+#include "triton/codegen/analysis/swizzle.h"
+#include "triton/codegen/target.h"
+#include "triton/ir/module.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/utils.h"
+
+namespace triton{
+namespace codegen{
+namespace analysis{
+
+// offset, in elements, of `coord` in a (swizzled) shared tile
+int64_t bank_conflicts::offset(shared_layout *layout, const coord_t &coord) {
+  const auto& shape = layout->get_shape();
+  const auto& ord = layout->get_order();
+  std::vector<int64_t> c(coord.begin(), coord.end());
+  for(size_t k = 0; k < c.size(); k++)
+    c[k] %= shape[k];
+  if(ord.size() >= 2){
+    int vec = swizzle_->get_vec(layout);
+    int per_phase = swizzle_->get_per_phase(layout);
+    int max_phase = swizzle_->get_max_phase(layout);
+    int64_t phase = (c[ord[1]] / per_phase) % max_phase;
+    c[ord[0]] = ((c[ord[0]] / vec) ^ phase) * vec + c[ord[0]] % vec;
+  }
+  int64_t off = 0;
+  int64_t stride = 1;
+  for(int d: ord){
+    off += c[d] * stride;
+    stride *= shape[d];
+  }
+  return off;
+}
+
+// coordinates of the first element owned by `lane` of the first warp
+bank_conflicts::coord_t bank_conflicts::lane_coord(scanline_layout *layout, int lane) {
+  const auto& ord = layout->get_order();
+  size_t dim = ord.size();
+  coord_t ret(dim);
+  int id = lane;
+  for(size_t k = 0; k < dim - 1; k++){
+    ret[ord[k]] = id % layout->mts(ord[k]);
+    id /= layout->mts(ord[k]);
+  }
+  ret[ord[dim - 1]] = id;
+  for(size_t k = 0; k < dim; k++)
+    ret[k] *= layout->nts(k);
+  return ret;
+}
+
+// Accesses wider than 32 bits are split in phases of 16 (64-bit) or 8
+// (128-bit) lanes. Within a phase, distinct words of the same bank are
+// serialized while identical words are broadcast.
+int bank_conflicts::degree(const std::vector<int64_t> &addrs, int width) {
+  int lanes_per_phase = width <= 4 ? 32 : 128 / width;
+  int ret = 1;
+  for(size_t p = 0; p < addrs.size(); p += lanes_per_phase){
+    std::map<int, std::set<int64_t>> words;
+    for(size_t l = p; l < std::min(addrs.size(), p + lanes_per_phase); l++)
+    for(int64_t w = addrs[l] / 4; w <= (addrs[l] + width - 1) / 4; w++)
+      words[w % 32].insert(w);
+    for(auto& x: words)
+      ret = std::max<int>(ret, x.second.size());
+  }
+  return ret;
+}
+
+void bank_conflicts::add(ir::value *v, int degree) {
+  degrees_[v] = std::max(degree, get(v));
+}
+
+void bank_conflicts::visit_copy_to_shared(ir::value *cts, ir::value *arg) {
+  shared_layout *out_layout = layouts_->get(cts)->to_shared();
+  scanline_layout *in_layout = layouts_->get(arg)->to_scanline();
+  if(!out_layout || !in_layout)
+    return;
+  int dtsize = out_layout->get_type()->get_primitive_size_in_bits() / 8;
+  int in_vec = 1;
+  if(out_layout->get_order() == in_layout->get_order())
+    in_vec = in_layout->nts(in_layout->get_order(0));
+  int min_vec = std::min(in_vec, swizzle_->get_vec(out_layout));
+  std::vector<int64_t> addrs;
+  for(int lane = 0; lane < 32; lane++)
+    addrs.push_back(offset(out_layout, lane_coord(in_layout, lane)) * dtsize);
+  add(cts, degree(addrs, min_vec * dtsize));
+}
+
+void bank_conflicts::visit_dot(ir::value *v) {
+  auto *dot = (ir::instruction*)v;
+  shared_layout *layout_a = layouts_->get(dot->get_operand(0))->to_shared();
+  shared_layout *layout_b = layouts_->get(dot->get_operand(1))->to_shared();
+  if(!layout_a || !layout_b || layout_a->get_rank() != 2)
+    return;
+  int dtsize = layout_a->get_type()->get_primitive_size_in_bits() / 8;
+  bool is_a_row = layout_a->get_order(0) == 1;
+  bool is_b_row = layout_b->get_order(0) == 1;
+  std::vector<int64_t> addrs_a, addrs_b;
+  int width;
+  if(mma_layout *mma = layouts_->get(dot)->to_mma()){
+    // the m8n8k4 lowering of sm70 does not use ldmatrix
+    if(tgt_->as_nvidia()->sm() < 75)
+      return;
+    // ldmatrix.x4: lane l gives the address of row l % 8 of matrix l / 8,
+    // and each row is 16 contiguous bytes
+    int k_half = 16 / dtsize;
+    for(int lane = 0; lane < 32; lane++){
+      int q = lane / 8;
+      int r = lane % 8;
+      coord_t a = is_a_row ? coord_t{(q % 2)*8 + r, (q / 2)*k_half}
+                           : coord_t{(q % 2)*8, (q / 2)*8 + r};
+      coord_t b = is_b_row ? coord_t{(q % 2)*8 + r, (q / 2)*8*mma->wpt(1)}
+                           : coord_t{(q % 2)*k_half, (q / 2)*8*mma->wpt(1) + r};
+      addrs_a.push_back(offset(layout_a, a) * dtsize);
+      addrs_b.push_back(offset(layout_b, b) * dtsize);
+    }
+    width = 16;
+  }
+  else if(scanline_layout *layout_c = layouts_->get(dot)->to_scanline()){
+    // fma: scalar reads of the first element along K
+    for(int lane = 0; lane < 32; lane++){
+      coord_t c = lane_coord(layout_c, lane);
+      addrs_a.push_back(offset(layout_a, {c[0], 0}) * dtsize);
+      addrs_b.push_back(offset(layout_b, {0, c[1]}) * dtsize);
+    }
+    width = dtsize;
+  }
+  else
+    return;
+  add(dot, std::max(degree(addrs_a, width), degree(addrs_b, width)));
+}
+
+void bank_conflicts::visit_recoalesce(ir::value *rc) {
+  ir::value *op = ((ir::instruction*)rc)->get_operand(0);
+  mma_layout *in_layout = layouts_->get(op)->to_mma();
+  scanline_layout *out_layout = layouts_->get(rc)->to_scanline();
+  if(!in_layout || !out_layout || !layouts_->has_tmp(rc) || tgt_->as_nvidia()->sm() < 75)
+    return;
+  shared_layout *tmp = layouts_->get(layouts_->tmp(rc))->to_shared();
+  int dtsize = tmp->get_type()->get_primitive_size_in_bits() / 8;
+  // the m16n8 accumulators of lane l start at row l / 4, column 2*(l % 4)
+  std::vector<int64_t> writes, reads;
+  for(int lane = 0; lane < 32; lane++){
+    writes.push_back(offset(tmp, {lane / 4, (lane % 4)*2}) * dtsize);
+    reads.push_back(offset(tmp, lane_coord(out_layout, lane)) * dtsize);
+  }
+  // reads are as wide as the contiguous elements of each thread, unless
+  // swizzling splits them
+  int out_vec = out_layout->nts(out_layout->get_order(0));
+  if(swizzle_->get_max_phase(tmp) > 1 && swizzle_->get_vec(tmp) % out_vec != 0)
+    out_vec = 1;
+  add(rc, std::max(degree(writes, dtsize), degree(reads, out_vec * dtsize)));
+}
+
+void bank_conflicts::run(ir::module &mod) {
+  degrees_.clear();
+  ir::for_each_instruction(mod, [this](ir::instruction *i) {
+    if(!i->get_type()->is_block_ty())
+      return;
+    if(auto *cts = dynamic_cast<ir::copy_to_shared_inst*>(i))
+      visit_copy_to_shared(cts, cts->get_operand(0));
+    if(auto *async = dynamic_cast<ir::masked_load_async_inst*>(i))
+      visit_copy_to_shared(async, async->get_pointer_operand());
+    if(dynamic_cast<ir::dot_inst*>(i))
+      visit_dot(i);
+    if(dynamic_cast<ir::recoalesce_inst*>(i))
+      visit_recoalesce(i);
+  });
+}
+
+unsigned bank_conflicts::num_conflicting() const {
+  return std::count_if(degrees_.begin(), degrees_.end(),
+                       [](const std::pair<ir::value*, int>& x) { return x.second > 1; });
+}
+
+int bank_conflicts::max_degree() const {
+  int ret = 1;
+  for(auto& x: degrees_)
+    ret = std::max(ret, x.second);
+  return ret;
+}
+
+}
+}
+}
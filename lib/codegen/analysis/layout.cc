@@ -30,12 +30,29 @@ inline bool is_hmma_c(ir::value *v){
     ir::type *a_ty = a->get_type();
     ir::value *b = x->get_operand(1);
     ir::type *b_ty = b->get_type();
-    result = a_ty->get_scalar_ty()->is_fp16_ty() &&
-             b_ty->get_scalar_ty()->is_fp16_ty();
+    result = (a_ty->get_scalar_ty()->is_fp16_ty() &&
+              b_ty->get_scalar_ty()->is_fp16_ty()) ||
+             (a_ty->get_scalar_ty()->is_integer_ty(8) &&
+              b_ty->get_scalar_ty()->is_integer_ty(8)) ||
+             (a_ty->get_scalar_ty()->is_fp32_ty() &&
+              b_ty->get_scalar_ty()->is_fp32_ty() && x->allow_tf32());
   }
   return result;
 }
 
+// int8 (m16n8k32) and tf32 (m16n8k8) tensor cores are only used on sm80+, and
+// only when both operands are contiguous along K: ldmatrix cannot transpose
+// elements that are not 16-bit wide
+inline bool is_mma_supported(ir::value *dot, shared_layout *layout_a, shared_layout *layout_b, target *tgt) {
+  ir::type *ty = ((ir::instruction*)dot)->get_operand(0)->get_type()->get_scalar_ty();
+  if(ty->is_fp16_ty())
+    return true;
+  int k_width = 256 / ty->get_primitive_size_in_bits();
+  return tgt->as_nvidia()->sm() >= 80 &&
+         layout_a->get_order()[0] == 1 && layout_b->get_order()[0] == 0 &&
+         layout_a->get_shape()[1] % k_width == 0;
+}
+
 inline void extract_io_use(ir::value *v, std::set<ir::value*>& result) {
   for(ir::user* u: v->get_users()){
     auto i = dynamic_cast<ir::io_inst*>(u);
@@ -119,6 +136,26 @@ data_layout::data_layout(id_t id,
 //    std::cout << max_contiguous[0] << " " << max_contiguous[1] << std::endl;
 //    std::cout << order_[0] << " " << order_[1] << std::endl;
   }
+  // accesses may disagree on their most contiguous axis: lead with the
+  // one that minimizes the number of memory instructions of the group,
+  // accesses along another axis being issued one element at a time
+  if(ptr.size() > 1 && order_.size() > 1){
+    std::vector<double> cost(order_.size(), 0);
+    for(ir::value* p: ptr){
+      std::vector<unsigned> curr = align->contiguous(p);
+      if(curr.size() != order_.size())
+        continue;
+      int axis = std::distance(curr.begin(), std::max_element(curr.begin(), curr.end()));
+      int nbits = p->get_type()->get_scalar_ty()->get_pointer_element_ty()->get_primitive_size_in_bits();
+      int vec = std::max<int>(std::min<int>(align->get(p, axis), 128 / nbits), 1);
+      for(size_t d = 0; d < cost.size(); d++)
+        cost[d] += (int)d == axis ? 1. / vec : 1.;
+    }
+    auto best = std::find(order_.begin(), order_.end(),
+                          std::distance(cost.begin(), std::min_element(cost.begin(), cost.end())));
+    if(cost[*best] < cost[order_[0]])
+      std::rotate(order_.begin(), best, best + 1);
+  }
 }
 
 int data_layout::find_axis(int to_find) const {
@@ -141,7 +178,7 @@ mma_layout::mma_layout(size_t num_warps,
                        shared_layout *layout_a, shared_layout *layout_b): data_layout(MMA, axes, shape, values, align) {
   /* fragments per warp */
   // try to make things as square as possible to maximize data re-use
-  if(tgt->as_nvidia()->sm() < 80){
+  if(tgt->as_nvidia()->sm() < 75){
     fpw_ = {2, 2, 1};
 //    std::vector<int> fpw_nm1;
 //    unsigned num_fragments = std::min<unsigned>((shape_[0]/8)*(shape_[1]/8), 4);
@@ -232,6 +269,19 @@ scanline_layout::scanline_layout(size_t num_warps,
   }
 }
 
+int scanline_layout::thread_stride(size_t k) {
+  int result = 1;
+  for(size_t d = 0; order_[d] != (int)k; d++)
+    result *= mts_[order_[d]];
+  return result;
+}
+
+int scanline_layout::warps_along(size_t k) {
+  int lo = thread_stride(k);
+  int hi = lo * mts_[k];
+  return hi <= 32 ? 1 : hi / std::max(lo, 32);
+}
+
 
 /* -------------------------------- *
  *          Shared Layout           *
@@ -416,7 +466,7 @@ size_t shared_layout::get_per_stage_elements() const {
  * -------------------------------- */
 
 layouts::layouts(analysis::axes *axes, analysis::align *align, size_t num_warps, target* tgt)
-  : axes_(axes), align_(align), num_warps_(num_warps), tgt_(tgt){ }
+  : axes_(axes), align_(align), num_warps_(num_warps), tgt_(tgt), num_fused_(0){ }
 
 
 void layouts::connect(ir::value *x, ir::value *y) {
@@ -467,13 +517,21 @@ void layouts::create(size_t id, const std::vector<ir::value*>& values) {
              dynamic_cast<ir::masked_load_async_inst*>(v);
   });
   // type
+  shared_layout *layout_a = nullptr;
+  shared_layout *layout_b = nullptr;
   if(it_hmma_c != values.end()){
     ir::instruction *dot = (ir::instruction*)*it_hmma_c;
     ir::value *a = dot->get_operand(0);
     ir::value *b = dot->get_operand(1);
     create(groups_.at(a), values_.at(groups_.at(a)));
     create(groups_.at(b), values_.at(groups_.at(b)));
-    layouts_[id] = new mma_layout(num_warps_, axes, shapes, values, align_, tgt_, (shared_layout*)layouts_.at(groups_.at(a)), (shared_layout*)layouts_.at(groups_.at(b)));
+    layout_a = (shared_layout*)layouts_.at(groups_.at(a));
+    layout_b = (shared_layout*)layouts_.at(groups_.at(b));
+    if(!is_mma_supported(dot, layout_a, layout_b, tgt_))
+      it_hmma_c = values.end();
+  }
+  if(it_hmma_c != values.end()){
+    layouts_[id] = new mma_layout(num_warps_, axes, shapes, values, align_, tgt_, layout_a, layout_b);
   }
   else if(it_cts != values.end()){
     ir::instruction *cts = (ir::instruction*)*it_cts;
@@ -486,6 +544,47 @@ void layouts::create(size_t id, const std::vector<ir::value*>& values) {
   }
 }
 
+// Independent reductions of the same tile along the same axis are
+// emitted together, at the last of them, so that they share warp
+// shuffles, shared memory and barriers. A group stops growing once
+// one of its results is used.
+void layouts::fuse_reductions(ir::module &mod) {
+  fused_.clear();
+  num_fused_ = 0;
+  for(ir::function *fn: mod.get_function_list())
+  for(ir::basic_block *block: fn->blocks()){
+    // open groups, by their first member
+    std::vector<ir::reduce_inst*> open;
+    std::map<ir::value*, ir::reduce_inst*> first;
+    std::vector<ir::reduce_inst*> reds;
+    for(ir::instruction *i: block->get_inst_list()){
+      for(ir::value *op: i->ops())
+      if(first.count(op))
+        open.erase(std::remove(open.begin(), open.end(), first.at(op)), open.end());
+      auto *red = dynamic_cast<ir::reduce_inst*>(i);
+      if(!red)
+        continue;
+      reds.push_back(red);
+      ir::value *arg = red->get_operand(0);
+      auto it = std::find_if(open.begin(), open.end(), [&](ir::reduce_inst *f) {
+        return f->get_axis() == red->get_axis() && layout_of(f->get_operand(0)) == layout_of(arg);
+      });
+      if(it == open.end() || !get(arg)->to_scanline()){
+        open.push_back(red);
+        first[red] = red;
+        fused_[red] = {red};
+        continue;
+      }
+      first[red] = *it;
+      fused_[*it].push_back(red);
+      num_fused_++;
+    }
+    // every member sees the whole group
+    for(ir::reduce_inst *red: reds)
+      fused_[red] = fused_.at(first.at(red));
+  }
+}
+
 void layouts::run(ir::module &mod) {
   // make graph
   graph_.clear();
@@ -501,20 +600,59 @@ void layouts::run(ir::module &mod) {
     create(x.first, x.second);
 
   // create temporaries
+  fuse_reductions(mod);
   size_t id = values_.size();
   ir::for_each_instruction(mod, [this, &id](ir::instruction* i) {
     if(auto *red = dynamic_cast<ir::reduce_inst*>(i)) {
-      id++;
+      // fused reductions use the buffer of the last one
+      if(is_fused(red))
+        return;
       ir::value *arg = red->get_operand(0);
       unsigned axis = red->get_axis();
-      // shape
-      auto shapes = arg->get_type()->get_block_shapes();
+      // shared memory is only needed to combine partial
+      // results across warps; one per warp along `axis`
       scanline_layout *layout = get(arg)->to_scanline();
-      shapes[axis] = layout->mts(axis);
+      if(layout->warps_along(axis) == 1)
+        return;
+      id++;
+      // each reduction exchanges one word per warp, and (value, index)
+      // pairs two words. Words of a single plain reduction keep its type
+      const auto& group = fused_with(red);
+      ir::type *ty = red->get_type()->get_scalar_ty();
+      int num_words = 0;
+      bool is_wide = false;
+      for(ir::reduce_inst *r: group){
+        num_words += r->with_index() ? 2 : 1;
+        is_wide |= r->get_operand(0)->get_type()->get_scalar_ty()->get_primitive_size_in_bits() > 32;
+      }
+      if(num_words > 1)
+        ty = is_wide ? ir::type::get_int64_ty(ty->get_context())
+                     : ir::type::get_int32_ty(ty->get_context());
+      auto shapes = arg->get_type()->get_block_shapes();
+      shapes[axis] = layout->warps_along(axis) * num_words;
       // create layout
-      layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {red}, red->get_type()->get_scalar_ty(), align_);
+      layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {red}, ty, align_);
       tmp_[red] = id;
     }
+    if(auto *scan = dynamic_cast<ir::scan_inst*>(i)) {
+      ir::value *arg = scan->get_operand(0);
+      unsigned axis = scan->get_axis();
+      // one running total per warp along `axis` and per repetition
+      // of the layout along `axis`
+      scanline_layout *layout = get(arg)->to_scanline();
+      if(!layout || layout->warps_along(axis) == 1)
+        return;
+      id++;
+      auto shapes = arg->get_type()->get_block_shapes();
+      int num_reps = shapes[axis] / (layout->nts(axis) * layout->mts(axis));
+      shapes[axis] = layout->warps_along(axis) * std::max(num_reps, 1);
+      // bf16 is accumulated in fp32
+      ir::type *ty = scan->get_type()->get_scalar_ty();
+      if(ty->is_bf16_ty())
+        ty = ir::type::get_fp32_ty(ty->get_context());
+      layouts_[id] = new shared_layout(layout, axes_->get(arg), shapes, {scan}, ty, align_);
+      tmp_[scan] = id;
+    }
     if(auto *recoalasce = dynamic_cast<ir::recoalesce_inst*>(i)){
       ir::value *val = recoalasce->get_operand(0);
       mma_layout* in_layout = get(val)->to_mma();
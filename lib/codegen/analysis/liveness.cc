@@ -2,7 +2,9 @@
 #include <iostream>
 #include "triton/codegen/analysis/liveness.h"
 #include "triton/codegen/analysis/layout.h"
+#include "triton/ir/basic_block.h"
 #include "triton/ir/function.h"
+#include "triton/ir/instructions.h"
 #include "triton/ir/module.h"
 #include "triton/ir/utils.h"
 
@@ -11,47 +13,118 @@ namespace codegen{
 namespace analysis{
 
 
+live_range liveness::compute(shared_layout* layout, ir::function* fn, const indices_map_t& indices) {
+  const std::vector<ir::value*>& values = layout->get_values();
+  std::set<ir::value*> in_layout(values.begin(), values.end());
+  // writes and reads of the buffer. Temporaries are only
+  // accessed by the instruction that owns them
+  std::set<ir::instruction*> writes, reads;
+  ir::value *owner = values.front();
+  if(layouts_->has_tmp(owner) && layouts_->get(layouts_->tmp(owner)) == layout){
+    writes.insert((ir::instruction*)owner);
+    reads.insert((ir::instruction*)owner);
+  }
+  else
+  for(ir::value *v: values){
+    if(dynamic_cast<ir::copy_to_shared_inst*>(v) || dynamic_cast<ir::masked_load_async_inst*>(v))
+      writes.insert((ir::instruction*)v);
+    for(ir::user *u: v->get_users())
+      if(!in_layout.count(u))
+        reads.insert((ir::instruction*)u);
+  }
+  // multi-stage buffers are written one stage at a time
+  bool kills = layout->get_num_stages() == 1;
+
+  // instructions reachable from a write
+  std::map<ir::basic_block*, bool> reached;
+  // instructions from which a read is reachable
+  std::map<ir::basic_block*, bool> live_out;
+  std::set<slot_index> slots;
+  std::vector<ir::basic_block*> blocks = fn->blocks();
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(ir::basic_block *block: blocks){
+      bool reach = reached[block];
+      for(ir::instruction *i: block->get_inst_list())
+        reach |= writes.count(i) > 0;
+      for(ir::basic_block *succ: block->get_successors())
+        if(reach && !reached[succ])
+          changed = reached[succ] = true;
+    }
+    for(auto it = blocks.rbegin(); it != blocks.rend(); it++){
+      ir::basic_block *block = *it;
+      bool live = live_out[block];
+      auto& insts = block->get_inst_list();
+      for(auto i = insts.rbegin(); i != insts.rend(); i++){
+        live |= reads.count(*i) > 0;
+        if(kills && writes.count(*i))
+          live = false;
+      }
+      for(ir::basic_block *pred: block->get_predecessors())
+        if(live && !live_out[pred])
+          changed = live_out[pred] = true;
+    }
+  }
+
+  // collect slots
+  for(ir::basic_block *block: blocks){
+    auto& insts = block->get_inst_list();
+    std::vector<bool> live(insts.size());
+    bool l = live_out[block];
+    size_t k = insts.size();
+    for(auto i = insts.rbegin(); i != insts.rend(); i++){
+      l |= reads.count(*i) > 0;
+      live[--k] = l || writes.count(*i);
+      if(kills && writes.count(*i))
+        l = false;
+    }
+    bool reach = reached[block];
+    k = 0;
+    for(ir::instruction *i: insts){
+      reach |= writes.count(i) > 0;
+      if(reach && live[k])
+        slots.insert(indices.at(i));
+      k++;
+    }
+  }
+
+  // merge consecutive slots into segments
+  live_range ret;
+  for(slot_index x: slots){
+    if(!ret.segments.empty() && ret.segments.back().end == x)
+      ret.segments.back().end = x + 1;
+    else
+      ret.segments.push_back(segment{x, x + 1});
+  }
+  if(ret.segments.empty()){
+    slot_index x = indices.at((ir::instruction*)owner);
+    ret.segments.push_back(segment{x, x + 1});
+  }
+  return ret;
+}
+
 void liveness::run(ir::module &mod) {
   intervals_.clear();
 
   // Assigns index to each instruction
-  std::map<ir::value*, slot_index> indices;
-  for(ir::function *fn: mod.get_function_list()){
-    slot_index index = 0;
-    for(ir::basic_block *block: fn->blocks())
-    for(ir::instruction *instr: block->get_inst_list()){
-      index += 1;
-      indices.insert({instr, index});
-    }
+  indices_map_t indices;
+  slot_index index = 0;
+  for(ir::function *fn: mod.get_function_list())
+  for(ir::basic_block *block: fn->blocks())
+  for(ir::instruction *instr: block->get_inst_list()){
+    index += 1;
+    indices.insert({instr, index});
   }
 
-  // create live intervals
+  // create live ranges
   for(auto &x: layouts_->get_all()) {
     shared_layout* layout = x.second->to_shared();
     if(!layout)
       continue;
-    // users
-    std::set<ir::user*> users;
-    for(ir::value *v: layout->get_values()){
-      for(ir::user *u: v->get_users())
-        users.insert(u);
-    }
-    // compute intervals
-    unsigned start = INT32_MAX;
-    for(ir::value *v: layout->get_values())
-      if(indices.find(v) != indices.end())
-        start = std::min(start, indices.at(v));
-    unsigned end = 0;
-    for(ir::user *u: users)
-      if(indices.find(u) != indices.end())
-        end = std::max(end, indices.at(u));
-    if(end == 0)
-      end = start + 1;
-    intervals_[layout] = segment{start, end};
+    ir::instruction *first = (ir::instruction*)layout->get_values().front();
+    intervals_[layout] = compute(layout, first->get_parent()->get_parent(), indices);
   }
-
-
-
 }
 
 }
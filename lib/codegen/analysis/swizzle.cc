@@ -2,12 +2,43 @@
 #include "triton/codegen/analysis/layout.h"
 #include "triton/codegen/target.h"
 #include "triton/ir/type.h"
+#include "triton/ir/instructions.h"
 #include <iostream>
 
 namespace triton{
 namespace codegen{
 namespace analysis{
 
+// Width of the chunks of a row of `layout` that are accessed together by a
+// warp when the row is read (or written) across threads, i.e., along the
+// non-contiguous axis. Returns 0 if all accesses follow the contiguous axis,
+// in which case swizzling cannot remove any bank conflict.
+int swizzle::transposed_vec(shared_layout *layout) {
+  int ord0 = layout->get_order()[0];
+  for(ir::value *v: layout->get_values()){
+    // temporary of recoalesce: the mma layout writes 8 contiguous elements
+    // of each row (4 threads x 2) or each column (8 threads)
+    auto *rc = dynamic_cast<ir::recoalesce_inst*>(v);
+    if(rc && layouts_->has_tmp(rc) && layouts_->get(layouts_->tmp(rc)) == layout){
+      if(tgt_->as_nvidia()->sm() < 75)
+        return 0;
+      return 8;
+    }
+    // operands of fma dots contiguous along K: threads read columns
+    for(ir::user *u: v->get_users()){
+      auto *dot = dynamic_cast<ir::dot_inst*>(u);
+      if(!dot || layouts_->get(dot)->to_mma())
+        continue;
+      bool is_transposed = (dot->get_operand(0) == v && ord0 == 1) ||
+                           (dot->get_operand(1) == v && ord0 == 0);
+      scanline_layout *in_layout = dynamic_cast<scanline_layout*>(layout->get_arg_layout());
+      if(is_transposed && in_layout)
+        return in_layout->nts(ord0);
+    }
+  }
+  return 0;
+}
+
 
 void swizzle::run(ir::module &) {
     per_phase_.clear();
@@ -19,10 +50,28 @@ void swizzle::run(ir::module &) {
         continue;
       ir::value* mma_dot_a = layout->hmma_dot_a();
       ir::value* mma_dot_b = layout->hmma_dot_b();
+      // int8 dots may still be lowered without tensor cores
+      if(mma_dot_a && !layouts_->get(mma_dot_a)->to_mma())
+        mma_dot_a = nullptr;
+      if(mma_dot_b && !layouts_->get(mma_dot_b)->to_mma())
+        mma_dot_b = nullptr;
       if(!mma_dot_a && !mma_dot_b){
         per_phase_[layout] = 1;
         max_phase_[layout] = 1;
         vec_[layout] = 1;
+        // rows read or written across threads: XOR the chunk index with the
+        // row so that the rows of a 128-byte line period fall in distinct banks
+        int vec = transposed_vec(layout);
+        if(vec == 0 || layout->get_order().size() < 2)
+          continue;
+        int dtsize = layout->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
+        int row_len = layout->get_shape()[layout->get_order()[0]];
+        vec = std::min(vec, row_len);
+        int per_phase = std::max<int>(128 / (row_len*dtsize), 1);
+        int max_phase = std::min<int>(std::max<int>(128 / (vec*dtsize) / per_phase, 1), row_len / vec);
+        per_phase_[layout] = per_phase;
+        max_phase_[layout] = max_phase;
+        vec_[layout] = max_phase > 1 ? vec : 1;
         continue;
       }
       auto ord = layout->get_order();
@@ -30,7 +79,7 @@ void swizzle::run(ir::module &) {
       if(!in_layout)
         continue;
       int dtsize = layout->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
-      if(tgt_->as_nvidia()->sm() < 80){
+      if(tgt_->as_nvidia()->sm() < 75){
         int inner = mma_dot_a ? 0 : 1;
         per_phase_[layout] = std::max<int>(128 / (in_layout->mts(ord[0])*in_layout->nts(ord[0])*dtsize), 1);
         max_phase_[layout] = (ord[inner] == 1 ? 8 : 4) / per_phase_[layout];
@@ -40,9 +89,12 @@ void swizzle::run(ir::module &) {
           vec_[layout] = 2*layouts_->get(mma_dot_b)->to_mma()->rep(1);
       }
       else{
-        per_phase_[layout] = std::max<int>(128 / (in_layout->mts(ord[0])*in_layout->nts(ord[0])*dtsize), 1);
+        // ldmatrix reads 8 rows of 16 bytes: swizzle at that granularity so
+        // that each group of 8 rows covers all 32 banks exactly once
+        int row_size = layout->get_shape()[ord[0]] * dtsize;
+        per_phase_[layout] = std::min<int>(std::max<int>(128 / row_size, 1), 8);
         max_phase_[layout] = 8 / per_phase_[layout];
-        vec_[layout]       = 8;
+        vec_[layout]       = 16 / dtsize;
       }
     }
 }
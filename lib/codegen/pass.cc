@@ -2,6 +2,7 @@
 #include "triton/codegen/analysis/align.h"
 #include "triton/codegen/analysis/allocation.h"
 #include "triton/codegen/analysis/axes.h"
+#include "triton/codegen/analysis/bank_conflicts.h"
 #include "triton/codegen/analysis/liveness.h"
 #include "triton/codegen/analysis/swizzle.h"
 #include "triton/codegen/selection/generator.h"
@@ -13,12 +14,16 @@
 #include "triton/codegen/transform/peephole.h"
 #include "triton/codegen/transform/pipeline.h"
 #include "triton/codegen/transform/prefetch.h"
+#include "triton/codegen/transform/strength_reduction.h"
+#include "triton/codegen/transform/unroll.h"
+#include "triton/codegen/transform/versioning.h"
 #include "triton/driver/device.h"
 #include "triton/driver/kernel.h"
 #include "triton/driver/module.h"
 #include "triton/ir/function.h"
 #include "triton/ir/module.h"
 #include "triton/ir/print.h"
+#include "triton/tools/sys/getenv.hpp"
 #include "llvm/IR/Module.h"
 
 namespace triton {
@@ -26,7 +31,7 @@ namespace codegen {
 
 // TODO:
 // There should be a proper pass manager there!
-void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps, int num_stages, bool force_nc_cache,
+report_t add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps, int num_stages, bool force_nc_cache, int unroll_max_size,
                             driver::module *&mod, driver::kernel *&ker, size_t &shared_mem) {
   // generate llvm code
   llvm::LLVMContext ctx;
@@ -41,9 +46,13 @@ void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps,
   codegen::transform::cts cts(cts_use_async);
   codegen::transform::pipeline pipeline(cts_use_async, num_stages);
   codegen::transform::disassociate disassociate;
+  codegen::transform::unroll unroll(unroll_max_size);
+  codegen::transform::strength_reduction strength_reduction;
+  codegen::transform::versioning versioning;
   codegen::analysis::layouts layouts(&axes, &align, num_warps, target.get());
   codegen::analysis::liveness liveness(&layouts);
   codegen::analysis::swizzle swizzle(&layouts, target.get());
+  codegen::analysis::bank_conflicts bank_conflicts(&layouts, &swizzle, target.get());
   codegen::analysis::allocation allocation(&liveness);
   codegen::transform::dce dce;
   codegen::transform::peephole peephole(target.get(), &layouts);
@@ -54,8 +63,16 @@ void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps,
   codegen::generator isel(&axes, &layouts, &align, &allocation, &swizzle, target.get(), num_warps, force_nc_cache);
   // run passes
   dce.run(ir);
+  unroll.run(ir);
   peephole.run(ir);
   dce.run(ir);
+  versioning.run(ir);
+  dce.run(ir);
+  // TRITON_DISABLE_STRENGTH_REDUCTION keeps the generic lowering, e.g. to
+  // compare the generated code with and without the pass
+  if(tools::getenv("TRITON_DISABLE_STRENGTH_REDUCTION").empty())
+    strength_reduction.run(ir);
+  dce.run(ir);
   // ir::print(ir, std::cout);
   pipeline.run(ir);
   dce.run(ir);
@@ -90,6 +107,7 @@ void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps,
   axes.run(ir);
   layouts.run(ir);
   swizzle.run(ir);
+  bank_conflicts.run(ir);
   liveness.run(ir);
   allocation.run(ir);
   prefetch_s.run(ir);
@@ -101,6 +119,31 @@ void add_passes_to_emit_bin(ir::module &ir, driver::device *dev, int num_warps,
   mod = driver::module::create(dev, std::move(llvm));
   ker = driver::kernel::create(&*mod, name.c_str());
   shared_mem = allocation.allocated_size();
+  // report
+  report_t report;
+  report["dce.dead_instructions"] = dce.num_dead_insts();
+  report["dce.dead_phis"] = dce.num_dead_phis();
+  report["dce.dead_branches"] = dce.num_dead_branches();
+  report["dce.dead_blocks"] = dce.num_dead_blocks();
+  report["unroll.unrolled_loops"] = unroll.num_unrolled_loops();
+  report["versioning.versioned_loops"] = versioning.num_versioned_loops();
+  report["strength_reduction.div_rem"] = strength_reduction.num_div_rem();
+  report["strength_reduction.iv_mul"] = strength_reduction.num_iv_mul();
+  report["pipeline.pipelined_loads"] = pipeline.num_pipelined_loads();
+  report["pipeline.staged_loads"] = pipeline.num_staged_loads();
+  report["layouts.fused_reductions"] = layouts.num_fused_reductions();
+  report["coalesce.staged_stores"] = coalesce.num_staged_stores();
+  report["coalesce.conversions"] = coalesce.num_conversions();
+  report["coalesce.avoided_conversions"] = coalesce.num_avoided_conversions();
+  report["bank_conflicts.accesses"] = bank_conflicts.num_accesses();
+  report["bank_conflicts.conflicting_accesses"] = bank_conflicts.num_conflicting();
+  report["bank_conflicts.max_degree"] = bank_conflicts.max_degree();
+  report["allocation.peak_live_bytes"] = allocation.peak_live_size();
+  report["allocation.allocated_bytes"] = allocation.allocated_size();
+  report["membar.inserted_barriers"] = barriers.num_inserted_barriers();
+  report["membar.barriers"] = barriers.num_barriers();
+  report["isel.align_limited_accesses"] = isel.num_align_limited();
+  return report;
 }
 
 } // namespace codegen
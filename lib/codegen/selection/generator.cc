@@ -1,6 +1,8 @@
 ﻿#include <numeric>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <iostream>
 #include "triton/codegen/selection/generator.h"
 #include "triton/codegen/target.h"
 #include "triton/codegen/analysis/axes.h"
@@ -12,6 +14,7 @@
 #include "triton/ir/module.h"
 #include "triton/ir/function.h"
 #include "triton/ir/type.h"
+#include "triton/tools/sys/getenv.hpp"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicsNVPTX.h"
@@ -107,13 +110,25 @@ Value* geper::operator()(Value *ptr, Value* off, const std::string& name){
 #define extract_val(...)     builder_->CreateExtractValue(__VA_ARGS__)
 #define fadd(...)            builder_->CreateFAdd(__VA_ARGS__)
 #define fcmp(...)            builder_->CreateFCmp(__VA_ARGS__)
+#define fcmp_oeq(...)        builder_->CreateFCmpOEQ(__VA_ARGS__)
+#define fcmp_oge(...)        builder_->CreateFCmpOGE(__VA_ARGS__)
+#define fcmp_ogt(...)        builder_->CreateFCmpOGT(__VA_ARGS__)
+#define fcmp_olt(...)        builder_->CreateFCmpOLT(__VA_ARGS__)
+#define fcmp_one(...)        builder_->CreateFCmpONE(__VA_ARGS__)
+#define fcmp_uno(...)        builder_->CreateFCmpUNO(__VA_ARGS__)
+#define fdiv(...)            builder_->CreateFDiv(__VA_ARGS__)
 #define fmul(...)            builder_->CreateFMul(__VA_ARGS__)
+#define fneg(...)            builder_->CreateFNeg(__VA_ARGS__)
 #define fpcast(...)          builder_->CreateFPCast(__VA_ARGS__)
 #define fsub(...)            builder_->CreateFSub(__VA_ARGS__)
 #define icmp(...)            builder_->CreateICmp(__VA_ARGS__)
 #define icmp_eq(...)         builder_->CreateICmpEQ(__VA_ARGS__)
 #define icmp_sge(...)        builder_->CreateICmpSGE(__VA_ARGS__)
+#define icmp_sgt(...)        builder_->CreateICmpSGT(__VA_ARGS__)
 #define icmp_sle(...)        builder_->CreateICmpSLE(__VA_ARGS__)
+#define icmp_slt(...)        builder_->CreateICmpSLT(__VA_ARGS__)
+#define icmp_uge(...)        builder_->CreateICmpUGE(__VA_ARGS__)
+#define icmp_ugt(...)        builder_->CreateICmpUGT(__VA_ARGS__)
 #define icmp_ult(...)        builder_->CreateICmpULT(__VA_ARGS__)
 #define insert_elt(...)      builder_->CreateInsertElement(__VA_ARGS__)
 #define intrinsic(...)       builder_->CreateIntrinsic(__VA_ARGS__)
@@ -122,6 +137,8 @@ Value* geper::operator()(Value *ptr, Value* off, const std::string& name){
 #define max_num(...)         builder_->CreateMaxNum(__VA_ARGS__)
 #define min_num(...)         builder_->CreateMinNum(__VA_ARGS__)
 #define neg(...)             builder_->CreateNeg(__VA_ARGS__)
+#define not_(...)            builder_->CreateNot(__VA_ARGS__)
+#define or_(...)             builder_->CreateOr(__VA_ARGS__)
 #define phi(...)             builder_->CreatePHI(__VA_ARGS__)
 #define ret(...)             builder_->CreateRet(__VA_ARGS__)
 #define select(...)          builder_->CreateSelect(__VA_ARGS__)
@@ -199,7 +216,8 @@ generator::generator(analysis::axes *a_axes,
                     target *tgt,
                     unsigned num_warps, bool force_nc_cache)
   : a_axes_(a_axes), layouts_(layouts), alignment_(alignment), alloc_(alloc), swizzle_(swizzle),
-    tgt_(tgt), num_warps_(num_warps), force_nc_cache_(force_nc_cache), add(&builder_), mul(&builder_), gep(&builder_) {
+    tgt_(tgt), num_warps_(num_warps), force_nc_cache_(force_nc_cache), num_align_limited_(0),
+    add(&builder_), mul(&builder_), gep(&builder_) {
 
 }
 
@@ -310,6 +328,48 @@ void generator::visit_binary_operator(ir::binary_operator*x) {
       default: throw std::runtime_error("unreachable switch");
     }
   };
+  ir::type* sca_ty = x->get_type()->get_scalar_ty();
+  bool is_fp_arith = x->get_op() == ir::binary_op_t::FAdd ||
+                     x->get_op() == ir::binary_op_t::FSub ||
+                     x->get_op() == ir::binary_op_t::FMul;
+  bool has_bf16x2 = tgt_->as_nvidia() && tgt_->as_nvidia()->sm() >= 80;
+  // pairs of adjacent 16-bit floats are processed as f16x2 / bf16x2
+  if(is_fp_arith && (sca_ty->is_fp16_ty() || (sca_ty->is_bf16_ty() && has_bf16x2)) && is_x2_packable(x)){
+    // bf16x2 add/sub/mul are only available as fma
+    InlineAsm *fma_bf16x2 = InlineAsm::get(FunctionType::get(i32_ty, {i32_ty, i32_ty, i32_ty}, false),
+                                           "fma.rn.bf16x2 $0, $1, $2, $3;", "=r,r,r,r", false);
+    const auto& idxs = idxs_.at(x);
+    for(size_t i = 0; i < idxs.size(); i += 2){
+      Value *lhs = pack_x2(vals_[x->get_operand(0)][idxs[i]], vals_[x->get_operand(0)][idxs[i+1]]);
+      Value *rhs = pack_x2(vals_[x->get_operand(1)][idxs[i]], vals_[x->get_operand(1)][idxs[i+1]]);
+      Value *ret;
+      if(sca_ty->is_fp16_ty())
+        ret = bin_op(cvt(x->get_op()), lhs, rhs);
+      else {
+        Type *vec = lhs->getType();
+        lhs = bit_cast(lhs, i32_ty);
+        rhs = bit_cast(rhs, i32_ty);
+        switch(x->get_op()){
+          case ir::binary_op_t::FAdd: ret = call(fma_bf16x2, {lhs, i32(0x3f803f80), rhs}); break;
+          case ir::binary_op_t::FSub: ret = call(fma_bf16x2, {rhs, i32(0xbf80bf80), lhs}); break;
+          default:                    ret = call(fma_bf16x2, {lhs, rhs, i32(0x80008000)}); break;
+        }
+        ret = bit_cast(ret, vec);
+      }
+      vals_[x][idxs[i]] = extract_elt(ret, (uint64_t)0);
+      vals_[x][idxs[i+1]] = extract_elt(ret, (uint64_t)1);
+    }
+    return;
+  }
+  // bf16 is stored as i16: other cases go through fp32
+  if(sca_ty->is_bf16_ty()){
+    for(indices_t idx: idxs_.at(x)){
+      Value *lhs = bf16_to_fp32(vals_[x->get_operand(0)][idx]);
+      Value *rhs = bf16_to_fp32(vals_[x->get_operand(1)][idx]);
+      vals_[x][idx] = fp32_to_bf16(bin_op(cvt(x->get_op()), lhs, rhs));
+    }
+    return;
+  }
   for(indices_t idx: idxs_.at(x)){
     Value *lhs = vals_[x->get_operand(0)][idx];
     Value *rhs = vals_[x->get_operand(1)][idx];
@@ -397,13 +457,38 @@ void generator::visit_fcmp_inst(ir::fcmp_inst* x) {
       default: throw std::runtime_error("unreachable switch");
     }
   };
+  bool is_bf16 = x->get_operand(0)->get_type()->get_scalar_ty()->is_bf16_ty();
   for(indices_t idx: idxs_.at(x)){
     Value *lhs = vals_[x->get_operand(0)][idx];
     Value *rhs = vals_[x->get_operand(1)][idx];
+    if(is_bf16){
+      lhs = bf16_to_fp32(lhs);
+      rhs = bf16_to_fp32(rhs);
+    }
     vals_[x][idx] = fcmp(cvt(x->get_pred()), lhs, rhs);
   }
 }
 
+/**
+ * \brief Whether each thread owns an even number of contiguous
+ * elements of `x`, so that consecutive indices can be paired
+ */
+bool generator::is_x2_packable(ir::value *x) {
+  if(!x->get_type()->is_block_ty())
+    return false;
+  analysis::scanline_layout* layout = layouts_->get(x)->to_scanline();
+  if(!layout)
+    return false;
+  return layout->nts(layout->get_order(0)) % 2 == 0 && idxs_.at(x).size() % 2 == 0;
+}
+
+Value* generator::pack_x2(Value *in0, Value *in1) {
+  Value *ret = UndefValue::get(vec_ty(in0->getType(), 2));
+  ret = insert_elt(ret, in0, (uint64_t)0);
+  ret = insert_elt(ret, in1, (uint64_t)1);
+  return ret;
+}
+
 
 std::tuple<Value*, Value*, Value*, Value*> generator::fp32x4_to_fp8x4(Value *in0, Value *in1, Value *in2, Value *in3){
     auto cvt = [this](Value *v){
@@ -510,6 +595,23 @@ void generator::visit_cast_inst(ir::cast_inst* x) {
     return;
   }
 
+  // FP32 -> FP16x2 / BF16x2
+  bool has_cvt_x2 = tgt_->as_nvidia() && tgt_->as_nvidia()->sm() >= 80;
+  if(op_sca_ty->is_fp32_ty() && (ret_sca_ty->is_fp16_ty() || ret_sca_ty->is_bf16_ty())
+     && has_cvt_x2 && is_x2_packable(x)){
+    Type *ty = ret_sca_ty->is_fp16_ty() ? f16_ty : builder_->getInt16Ty();
+    std::string asm_str = ret_sca_ty->is_fp16_ty() ? "cvt.rn.f16x2.f32 $0, $1, $2;" : "cvt.rn.bf16x2.f32 $0, $1, $2;";
+    InlineAsm *ptx = InlineAsm::get(FunctionType::get(i32_ty, {f32_ty, f32_ty}, false), asm_str, "=r,r,r", false);
+    for(size_t i = 0; i < x_idxs.size(); i += 2){
+      // the first source operand goes to the upper half
+      Value *ret = call(ptx, {vals_[op][op_idxs[i + 1]], vals_[op][op_idxs[i + 0]]});
+      ret = bit_cast(ret, vec_ty(ty, 2));
+      vals_[x][x_idxs[i + 0]] = extract_elt(ret, (uint64_t)0);
+      vals_[x][x_idxs[i + 1]] = extract_elt(ret, (uint64_t)1);
+    }
+    return;
+  }
+
   // <> BF16
   if(ret_sca_ty->is_bf16_ty() || op_sca_ty->is_bf16_ty()){
     // FP32 -> BF16
@@ -577,6 +679,54 @@ void generator::visit_uncond_branch_inst(ir::uncond_branch_inst* br) {
   br(dest);
 }
 
+/**
+ * \brief PTX cache operator of a global memory access
+ */
+std::string generator::cache_operator(ir::io_inst* x) {
+  switch(x->get_cache_modifier()){
+  case ir::io_inst::CA: return ".ca";
+  case ir::io_inst::CG: return ".cg";
+  case ir::io_inst::CS: return ".cs";
+  case ir::io_inst::LU: return ".lu";
+  case ir::io_inst::WB: return ".wb";
+  case ir::io_inst::WT: return ".wt";
+  default: return "";
+  }
+}
+
+/**
+ * \brief L2 cache policy of a global memory access, or nullptr
+ * when it has none. Eviction priorities require sm80+
+ * and are dropped on older devices
+ */
+Value* generator::cache_policy(ir::io_inst* x) {
+  ir::io_inst::EVICTION_POLICY policy = x->get_eviction_policy();
+  if(policy == ir::io_inst::NORMAL || tgt_->as_nvidia()->sm() < 80)
+    return nullptr;
+  std::string priority = policy == ir::io_inst::EVICT_FIRST ? "evict_first" : "evict_last";
+  InlineAsm *create = InlineAsm::get(FunctionType::get(builder_->getInt64Ty(), {}, false),
+                                     "createpolicy.fractional.L2::" + priority + ".b64 $0, 1.0;", "=l", false);
+  return call(create, {});
+}
+
+/**
+ * \brief Vector width of a global memory access along `axis`: the
+ * number of contiguous elements per thread, unless the pointer is
+ * known to be less aligned. The latter is counted, and printed as a
+ * remark when TRITON_REMARKS is set
+ */
+size_t generator::vector_width(ir::io_inst* x, ir::value *ptr, int axis, size_t nts) {
+  size_t aln = alignment_->get(ptr, axis);
+  if(aln >= nts)
+    return nts;
+  num_align_limited_++;
+  if(!tools::getenv("TRITON_REMARKS").empty())
+    std::cerr << "remark: " << x->repr() << " " << x->get_name() << ": vector width limited to "
+              << aln << " (instead of " << nts << ") by the alignment of its pointer along axis "
+              << axis << std::endl;
+  return aln;
+}
+
 /**
  * \brief Code Generation for a (synchronous) `load`
  */
@@ -588,10 +738,14 @@ void generator::visit_load_inst(ir::load_inst* x){
   size_t vec = 1;
   if(op->get_type()->is_block_ty()){
     auto   ord = ords_.at(op);
-    size_t aln = alignment_->get(op, ord[0]);
     size_t nts = layouts_->get(x)->to_scanline()->nts(ord[0]);
-    vec = std::min(nts, aln);
+    vec = vector_width(x, op, ord[0], nts);
   }
+  // cache hints
+  std::string cache = cache_operator(x);
+  if(cache.empty())
+    cache = force_nc_cache_ ? ".nc" : ".cg";
+  Value *policy = cache_policy(x);
   // code generation
   auto idxs = idxs_.at(x);
   for(size_t i = 0; i < idxs.size(); i += vec){
@@ -625,11 +779,11 @@ void generator::visit_load_inst(ir::load_inst* x){
     // create inline asm string
     // -----
     std::ostringstream asm_oss;
-    asm_oss << "@$" << n_words; // predicate
-    if(force_nc_cache_)
-      asm_oss << " ld.global.nc";
-    else
-      asm_oss << " ld.global.cg";
+    if(mx)
+      asm_oss << "@$" << n_words << " "; // predicate
+    asm_oss << "ld.global" << cache;
+    if(policy)
+      asm_oss << ".L2::cache_hint";
     if(n_words > 1)
       asm_oss << ".v" << n_words; // vector width
     asm_oss << ".b" << width; // word size
@@ -640,7 +794,11 @@ void generator::visit_load_inst(ir::load_inst* x){
     }
     asm_oss << "}";
     asm_oss << ", [ $" << n_words + 1; // load
-    asm_oss << " + " << in_off << "];"; // constant offset
+    asm_oss << " + " << in_off << "]"; // constant offset
+    if(policy)
+      asm_oss << ", $" << n_words + 2; // cache policy
+    asm_oss << ";";
+    int first_other = n_words + 2 + (policy ? 1 : 0);
     bool has_other = other && (other != UndefValue::get(other->getType()));
     std::vector<Value *> others;
     // handle `other` values for indices where the mask
@@ -661,7 +819,7 @@ void generator::visit_load_inst(ir::load_inst* x){
       if(ConstantInt* cst = dyn_cast<ConstantInt>(v))
         asm_oss << "0x" << std::hex << cst->getSExtValue();
       else{
-        asm_oss << "$" << n_words + 2 + ii;
+        asm_oss << "$" << first_other + others.size();
         others.push_back(v);
       }
       asm_oss.flags(flags);
@@ -673,6 +831,8 @@ void generator::visit_load_inst(ir::load_inst* x){
     std::vector<Type*> ret_tys(n_words, IntegerType::get(*ctx_, width));
     Type* ret_ty = ret_tys.size() > 1 ? StructType::get(*ctx_, ret_tys) : ret_tys[0];
     std::vector<Type*> arg_tys = {pred->getType(), ptr->getType()};
+    if(policy)
+        arg_tys.push_back(policy->getType());
     for(Value *v: others)
         arg_tys.push_back(v->getType());
     FunctionType *asm_ty = FunctionType::get(ret_ty, arg_tys, false);
@@ -685,6 +845,8 @@ void generator::visit_load_inst(ir::load_inst* x){
       asm_cstrt += (width == 64) ? "=l" : ((width == 32) ? "=r" : "=c");
     }
     asm_cstrt += ",b,l";
+    if(policy)
+      asm_cstrt += ",l";
     for(size_t ii = 0; ii < others.size(); ii++){
       asm_cstrt += ",";
       asm_cstrt += (width == 64) ? "l" : ((width == 32) ? "r" : "c");
@@ -694,6 +856,8 @@ void generator::visit_load_inst(ir::load_inst* x){
     // ---
     InlineAsm *_asm = InlineAsm::get(asm_ty, asm_oss.str(), asm_cstrt, true);
     std::vector<Value*> args = {pred, ptr};
+    if(policy)
+        args.push_back(policy);
     for(Value *v: others)
         args.push_back(v);
     Value *_ret = call(_asm, args);
@@ -735,12 +899,15 @@ void generator::visit_store_inst(ir::store_inst * x){
   size_t vec = 1;
   if(val_op->get_type()->is_block_ty()){
     auto ord = ords_.at(x->get_pointer_operand());
-    size_t aln = alignment_->get(ptr_op, ord[0]);
     size_t nts = axes_.at(a_axes_->get(x->get_pointer_operand(), ord[0])).contiguous;
-    vec  = std::min(nts, aln);
+    vec  = vector_width(x, ptr_op, ord[0], nts);
   }
   auto idxs    = idxs_.at(val_op);
   Type *ty = cvt(val_op->get_type()->get_scalar_ty());
+  // cache hints are only expressible in inline PTX
+  std::string cache = cache_operator(x);
+  Value *policy = cache_policy(x);
+  bool has_hints = !cache.empty() || policy;
   for(size_t i = 0; i < idxs.size(); i += vec){
     auto idx = idxs[i];
     // pointer
@@ -750,7 +917,48 @@ void generator::visit_store_inst(ir::store_inst * x){
     Value* val = UndefValue::get(vec_ty(ty, vec));
     for(size_t ii = 0; ii < vec; ii++)
       val = insert_elt(val, vals_.at(val_op)[idxs[i + ii]], ii);
-    if(mx){
+    if(has_hints){
+      Value *pred = mx ? vals_[mx->get_mask_operand()][idx] : builder_->getTrue();
+      // pack sub-words into words, as for loads
+      int nbits = ty->getPrimitiveSizeInBits();
+      int tot_width = nbits*vec;
+      int width = std::min(tot_width, std::max(32, nbits));
+      int n_words = std::max(1, tot_width / width);
+      Type *word_ty = IntegerType::get(*ctx_, width);
+      Value *words = bit_cast(val, vec_ty(word_ty, n_words));
+      std::ostringstream asm_oss;
+      asm_oss << "@$0 st.global" << cache;
+      if(policy)
+        asm_oss << ".L2::cache_hint";
+      if(n_words > 1)
+        asm_oss << ".v" << n_words;
+      asm_oss << ".b" << width << " [ $1 + 0 ], ";
+      if(n_words > 1)
+        asm_oss << "{";
+      for(int ii = 0; ii < n_words; ii++)
+        asm_oss << (ii > 0 ? ", " : "") << "$" << 2 + ii;
+      if(n_words > 1)
+        asm_oss << "}";
+      if(policy)
+        asm_oss << ", $" << 2 + n_words;
+      asm_oss << ";";
+      std::string asm_cstrt = "b,l";
+      std::vector<Type*> arg_tys = {pred->getType(), ptr->getType()};
+      std::vector<Value*> args = {pred, ptr};
+      for(int ii = 0; ii < n_words; ii++){
+        asm_cstrt += (width == 64) ? ",l" : ((width == 32) ? ",r" : ((width == 16) ? ",h" : ",c"));
+        arg_tys.push_back(word_ty);
+        args.push_back(extract_elt(words, ii));
+      }
+      if(policy){
+        asm_cstrt += ",l";
+        arg_tys.push_back(policy->getType());
+        args.push_back(policy);
+      }
+      FunctionType *asm_ty = FunctionType::get(builder_->getVoidTy(), arg_tys, false);
+      call(InlineAsm::get(asm_ty, asm_oss.str(), asm_cstrt, true), args);
+    }
+    else if(mx){
       Value *msk = vals_[mx->get_mask_operand()][idx];
       Instruction *no_op = intrinsic(Intrinsic::donothing, {}, {});
       builder_->SetInsertPoint(no_op->getParent());
@@ -885,6 +1093,265 @@ void generator::visit_log_inst(ir::log_inst* x){
   }
 }
 
+//===----------------------------------------------------------------------===//
+//                        Transcendental functions
+//===----------------------------------------------------------------------===//
+//
+// Everything is evaluated in fp32 (fp16/bf16 are widened and rounded back).
+// Two accuracy tiers are available. Bounds are for normal fp32 results and
+// were measured against a long double reference:
+//
+//            accurate              approx (*.approx.f32 based)
+//  exp2      1 ulp                 2 ulp
+//  tanh      2 ulp                 4 ulp
+//  erf       2 ulp                 2 ulp
+//  sigmoid   3 ulp                 4 ulp for x >= 0, rel. 2^-21 (1 + |x|) otherwise
+//  rsqrt     2 ulp                 rel. 2^-22
+//  pow       2 ulp                 rel. 2^-21 (1 + |y| + |y log2(x)|)
+//
+// The accurate tier reduces exponentials to p(r) * 2^n with |r| <= ln(2)/2
+// (Cody-Waite), uses IEEE div/sqrt, and evaluates the logarithm of `pow`
+// in fp64. The approximate tier replaces exponentials, reciprocals and
+// logarithms with ex2/rcp/lg2/rsqrt.approx.f32. Polynomial coefficients
+// below are near-minimax fits.
+
+/**
+ * \brief Calls `<op>.approx.f32` on `x`
+ */
+Value* generator::approx_f32(const std::string &op, Value *x) {
+  FunctionType *fn_ty = FunctionType::get(f32_ty, {f32_ty}, false);
+  InlineAsm *ptx = InlineAsm::get(fn_ty, op + ".approx.f32 $0, $1;", "=f,f", false);
+  return call(ptx, {x});
+}
+
+/**
+ * \brief Evaluates sum_k coeffs[k] * x^k using Horner's scheme
+ */
+Value* generator::polynomial(Value *x, const std::vector<double> &coeffs) {
+  Type *ty = x->getType();
+  Value *ret = ConstantFP::get(ty, coeffs.back());
+  for(int k = (int)coeffs.size() - 2; k >= 0; k--)
+    ret = intrinsic(Intrinsic::fma, {ty}, {ret, x, ConstantFP::get(ty, coeffs[k])});
+  return ret;
+}
+
+/**
+ * \brief Computes e^r * 2^n for |r| <= ln(2)/2 and integral n in [-252, 254]
+ */
+Value* generator::exp_reduced_f32(Value *r, Value *n) {
+  static const std::vector<double> exp_coeffs = {1., 1., 1./2, 1./6, 1./24, 1./120, 1./720, 1./5040};
+  Value *p = polynomial(r, exp_coeffs);
+  // 2^n is applied in two steps so that neither factor is denormal/inf
+  Value *ni = cast(Instruction::FPToSI, n, i32_ty);
+  Value *n1 = builder_->CreateAShr(ni, i32(1));
+  Value *n2 = sub(ni, n1);
+  Value *s1 = bit_cast(shl(add(n1, i32(127)), i32(23)), f32_ty);
+  Value *s2 = bit_cast(shl(add(n2, i32(127)), i32(23)), f32_ty);
+  return fmul(fmul(p, s1), s2);
+}
+
+/**
+ * \brief Computes e^x (or 2^x when `base2` is set)
+ */
+Value* generator::exp_f32(Value *x, bool base2, bool approx) {
+  Constant *log2e = ConstantFP::get(f32_ty, 1.4426950408889634);
+  Constant *ln2_hi = ConstantFP::get(f32_ty, 6.931471825e-01);
+  Constant *ln2_lo = ConstantFP::get(f32_ty, -1.904654212e-09);
+  if(approx)
+    return approx_f32("ex2", base2 ? x : fmul(x, log2e));
+  Value *r, *n;
+  if(base2){
+    Value *c = min_num(max_num(x, ConstantFP::get(f32_ty, -151.)), ConstantFP::get(f32_ty, 129.));
+    n = intrinsic(Intrinsic::rint, {f32_ty}, {c});
+    Value *f = fsub(c, n);
+    r = intrinsic(Intrinsic::fma, {f32_ty}, {f, ln2_hi, fmul(f, ln2_lo)});
+  }
+  else{
+    Value *c = min_num(max_num(x, ConstantFP::get(f32_ty, -104.)), ConstantFP::get(f32_ty, 89.));
+    n = intrinsic(Intrinsic::rint, {f32_ty}, {fmul(c, log2e)});
+    Value *neg_n = fneg(n);
+    r = intrinsic(Intrinsic::fma, {f32_ty}, {neg_n, ln2_hi, c});
+    r = intrinsic(Intrinsic::fma, {f32_ty}, {neg_n, ln2_lo, r});
+  }
+  Value *ret = exp_reduced_f32(r, n);
+  // clamping drops NaNs
+  return select(fcmp_uno(x, x), x, ret);
+}
+
+/**
+ * \brief Computes 1/x
+ */
+Value* generator::rcp_f32(Value *x, bool approx) {
+  if(approx)
+    return approx_f32("rcp", x);
+  return fdiv(ConstantFP::get(f32_ty, 1.), x);
+}
+
+/**
+ * \brief Applies `fn` element-wise in fp32
+ */
+void generator::visit_math_inst(ir::math_inst *x, std::function<Value*(const std::vector<Value*>&)> fn) {
+  ir::type *ty = x->get_type()->get_scalar_ty();
+  for(indices_t idx: idxs_.at(x)){
+    std::vector<Value*> args;
+    for(ir::value *op: x->ops()){
+      Value *arg = vals_[op][idx];
+      args.push_back(ty->is_bf16_ty() ? bf16_to_fp32(arg) : fpcast(arg, f32_ty));
+    }
+    Value *ret = fn(args);
+    vals_[x][idx] = ty->is_bf16_ty() ? fp32_to_bf16(ret) : fpcast(ret, cvt(ty));
+  }
+}
+
+/**
+ * \brief Code Generation for `exp2`
+ */
+void generator::visit_exp2_inst(ir::exp2_inst* x){
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    return exp_f32(args[0], true, x->is_approx());
+  });
+}
+
+/**
+ * \brief Code Generation for `tanh`
+ */
+void generator::visit_tanh_inst(ir::tanh_inst* x){
+  // (tanh(x) - x) / x^3 as a polynomial in x^2, for |x| < 0.55
+  static const std::vector<double> tanh_coeffs = {
+    -3.333331645e-01, 1.333258599e-01, -5.385230854e-02, 2.107166685e-02, -6.274224725e-03
+  };
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    Value *v = args[0];
+    Value *a = intrinsic(Intrinsic::fabs, {f32_ty}, {v});
+    Value *t = fmul(v, v);
+    Value *small = intrinsic(Intrinsic::fma, {f32_ty}, {fmul(v, t), polynomial(t, tanh_coeffs), v});
+    // 1 - 2 / (e^(2|x|) + 1)
+    Value *e = exp_f32(fmul(a, ConstantFP::get(f32_ty, 2.)), false, x->is_approx());
+    Value *q = rcp_f32(fadd(e, ConstantFP::get(f32_ty, 1.)), x->is_approx());
+    Value *large = fsub(ConstantFP::get(f32_ty, 1.), fmul(q, ConstantFP::get(f32_ty, 2.)));
+    large = intrinsic(Intrinsic::copysign, {f32_ty}, {large, v});
+    return select(fcmp_olt(a, ConstantFP::get(f32_ty, 0.55)), small, large);
+  });
+}
+
+/**
+ * \brief Code Generation for `erf`
+ */
+void generator::visit_erf_inst(ir::erf_inst* x){
+  // erf(x) / x - 1 as a polynomial in x^2, for |x| < 1
+  static const std::vector<double> erf_coeffs = {
+    1.283791661e-01, -3.761262596e-01, 1.128358543e-01, -2.685381100e-02,
+    5.188327283e-03, -8.010191377e-04, 7.853853458e-05
+  };
+  // log(erfc(x)), for 1 <= x <= 3.92 (erf rounds to 1 past that)
+  static const std::vector<double> log_erfc_coeffs = {
+    2.400450612e-04, -1.129799366e+00, -6.328569055e-01, -1.086691096e-01,
+    2.518920600e-02, -4.042841960e-03, 3.153084836e-04, 2.767879414e-05,
+    -1.070377766e-05, 1.193068897e-06, -5.065999176e-08
+  };
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    Value *v = args[0];
+    Value *a = intrinsic(Intrinsic::fabs, {f32_ty}, {v});
+    Value *small = intrinsic(Intrinsic::fma, {f32_ty}, {v, polynomial(fmul(v, v), erf_coeffs), v});
+    Value *c = min_num(a, ConstantFP::get(f32_ty, 3.92));
+    Value *erfc = exp_f32(polynomial(c, log_erfc_coeffs), false, x->is_approx());
+    Value *large = fsub(ConstantFP::get(f32_ty, 1.), erfc);
+    large = select(fcmp_oge(a, ConstantFP::get(f32_ty, 3.92)), ConstantFP::get(f32_ty, 1.), large);
+    large = intrinsic(Intrinsic::copysign, {f32_ty}, {large, v});
+    Value *ret = select(fcmp_olt(a, ConstantFP::get(f32_ty, 1.)), small, large);
+    return select(fcmp_uno(v, v), v, ret);
+  });
+}
+
+/**
+ * \brief Code Generation for `sigmoid`
+ */
+void generator::visit_sigmoid_inst(ir::sigmoid_inst* x){
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    Value *v = args[0];
+    // 1 / (1 + e^-x) for x >= 0, e^x / (1 + e^x) otherwise, so that
+    // e never overflows
+    Value *a = intrinsic(Intrinsic::fabs, {f32_ty}, {v});
+    Value *e = exp_f32(fneg(a), false, x->is_approx());
+    Value *num = select(fcmp_oge(v, ConstantFP::get(f32_ty, 0.)), ConstantFP::get(f32_ty, 1.), e);
+    Value *den = fadd(e, ConstantFP::get(f32_ty, 1.));
+    if(x->is_approx())
+      return fmul(num, rcp_f32(den, true));
+    return fdiv(num, den);
+  });
+}
+
+/**
+ * \brief Code Generation for `rsqrt`
+ */
+void generator::visit_rsqrt_inst(ir::rsqrt_inst* x){
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    if(x->is_approx())
+      return approx_f32("rsqrt", args[0]);
+    return rcp_f32(intrinsic(Intrinsic::sqrt, {f32_ty}, {args[0]}), false);
+  });
+}
+
+/**
+ * \brief Code Generation for `pow`
+ */
+void generator::visit_pow_inst(ir::pow_inst* x){
+  // log(m) = 2 atanh(s), s = (m - 1) / (m + 1); coefficients of the odd
+  // series in s^2, enough for |s| <= 0.172
+  static const std::vector<double> atanh_coeffs = {
+    1., 1./3, 1./5, 1./7, 1./9, 1./11, 1./13, 1./15
+  };
+  Type *f64_ty = builder_->getDoubleTy();
+  Type *i64_ty = builder_->getInt64Ty();
+  auto f32 = [&](double v) { return ConstantFP::get(f32_ty, v); };
+  visit_math_inst(x, [&](const std::vector<Value*>& args){
+    Value *vx = args[0];
+    Value *vy = args[1];
+    Value *ax = intrinsic(Intrinsic::fabs, {f32_ty}, {vx});
+    Value *ret;
+    if(x->is_approx())
+      ret = approx_f32("ex2", fmul(vy, approx_f32("lg2", ax)));
+    else{
+      // log2(|x|) = e + log2(m), m in [sqrt(2)/2, sqrt(2)], in fp64
+      Value *bits = bit_cast(fpcast(ax, f64_ty), i64_ty);
+      Value *e = builder_->CreateTrunc(lshr(bits, builder_->getInt64(52)), i32_ty);
+      e = sub(and_(e, i32(0x7ff)), i32(1023));
+      Value *m = bit_cast(or_(and_(bits, builder_->getInt64((1ull << 52) - 1)),
+                                             builder_->getInt64(1023ull << 52)), f64_ty);
+      Value *is_big = fcmp_ogt(m, ConstantFP::get(f64_ty, 1.4142135623730951));
+      m = select(is_big, fmul(m, ConstantFP::get(f64_ty, 0.5)), m);
+      e = select(is_big, add(e, i32(1)), e);
+      Value *s = fdiv(fsub(m, ConstantFP::get(f64_ty, 1.)), fadd(m, ConstantFP::get(f64_ty, 1.)));
+      Value *log_m = fmul(fmul(s, polynomial(fmul(s, s), atanh_coeffs)), ConstantFP::get(f64_ty, 2. * 1.4426950408889634));
+      Value *l2 = fadd(cast(Instruction::SIToFP, e, f64_ty), log_m);
+      // 2^(y log2(x)) = 2^n * e^(f ln2)
+      Value *t = fmul(fpcast(vy, f64_ty), l2);
+      t = min_num(max_num(t, ConstantFP::get(f64_ty, -151.)), ConstantFP::get(f64_ty, 129.));
+      Value *n = intrinsic(Intrinsic::rint, {f64_ty}, {t});
+      Value *f = fpcast(fsub(t, n), f32_ty);
+      Value *r = intrinsic(Intrinsic::fma, {f32_ty}, {f, f32(6.931471825e-01), fmul(f, f32(-1.904654212e-09))});
+      ret = exp_reduced_f32(r, fpcast(n, f32_ty));
+    }
+    // special values
+    Value *inf = f32(INFINITY);
+    Value *y_neg = fcmp_olt(vy, f32(0.));
+    Value *y_int = fcmp_oeq(intrinsic(Intrinsic::floor, {f32_ty}, {vy}), vy);
+    Value *half_y = fmul(vy, f32(0.5));
+    Value *y_odd = and_(y_int, fcmp_one(intrinsic(Intrinsic::floor, {f32_ty}, {half_y}), half_y));
+    Value *x_neg = icmp_slt(bit_cast(vx, i32_ty), i32(0));
+    ret = select(fcmp_oeq(ax, f32(0.)), select(y_neg, inf, f32(0.)), ret);
+    ret = select(fcmp_oeq(ax, inf), select(y_neg, f32(0.), inf), ret);
+    ret = select(fcmp_oeq(ax, f32(1.)), f32(1.), ret);
+    ret = select(and_(x_neg, y_odd), fneg(ret), ret);
+    Value *nan = f32(NAN);
+    Value *neg_finite = and_(fcmp_olt(vx, f32(0.)), fcmp_one(vx, fneg(inf)));
+    ret = select(and_(neg_finite, not_(y_int)), nan, ret);
+    ret = select(or_(fcmp_uno(vx, vx), fcmp_uno(vy, vy)), nan, ret);
+    ret = select(or_(fcmp_oeq(vx, f32(1.)), fcmp_oeq(vy, f32(0.))), f32(1.), ret);
+    return ret;
+  });
+}
+
 /**
  * \brief Code Generation for `atomic_cas`
  */
@@ -944,6 +1411,168 @@ void generator::visit_atomic_exch_inst(ir::atomic_exch_inst* xchg) {
   tgt_->add_memfence(module, *builder_);
 }
 
+/**
+ * \brief Inline PTX for a predicated `atom.global` of `val` at `ptr`
+ */
+Value* generator::atomic_rmw_asm(ir::atomic_rmw_op_t op, Value *pred, Value *ptr, Value *val) {
+  Type* ty = val->getType();
+  size_t nbits = ty->getScalarSizeInBits();
+  int vec = ty->getPrimitiveSizeInBits() / nbits;
+  // extract pointer offset
+  std::string offset = "";
+  if(GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(ptr))
+  if(gep->getNumIndices() == 1)
+  if(ConstantInt *cst = dyn_cast<ConstantInt>(gep->idx_begin())){
+    offset = " + " + std::to_string(cst->getValue().getSExtValue()*nbits/8);
+    ptr = gep->getPointerOperand();
+  }
+  ptr = bit_cast(ptr, ty->getPointerTo(1));
+  // asm argument type
+  std::vector<Type*> arg_ty = {pred->getType(), ptr->getType(), val->getType()};
+  // asm function type
+  FunctionType *fn_ty = FunctionType::get(ty, arg_ty, false);
+  // asm string
+  std::string s_nbits = std::to_string(nbits);
+  std::string name;
+  std::string s_ty;
+  using tt = ir::atomic_rmw_op_t;
+  switch(op){
+    case tt::Or: name = "or"; s_ty = "b"; break;
+    case tt::And: name = "and"; s_ty = "b"; break;
+    case tt::Xor: name = "xor", s_ty = "b"; break;
+    case tt::Add: name = "add" , s_ty = "s"; break;
+    case tt::Min: name = "min", s_ty = "s"; break;
+    case tt::Max: name = "max", s_ty = "s"; break;
+    case tt::UMin: name = "min", s_ty = "u"; break;
+    case tt::UMax: name = "max", s_ty = "u"; break;
+    case tt::FAdd: name = "add", s_ty = "f"; break;
+  }
+  std::string s_vec = vec == 2 ? "x2" : "";
+  std::string mod = nbits == 32 ? "" : ".noftz";
+
+  std::string asm_str = "@$1 atom.global.gpu." + name + mod + "." + s_ty + s_nbits + s_vec + " $0, [$2" + offset + "], $3;";
+  std::string ty_id = nbits*vec == 32 ? "r" : "h";
+  std::string constraint = "=" + ty_id + ",b,l," + ty_id;
+  // create inline asm
+  InlineAsm *iasm = InlineAsm::get(fn_ty, asm_str, constraint, true);
+  // call asm
+  return call(iasm, (ArrayRef<Value*>{pred, ptr, val}));
+}
+
+/**
+ * \brief Warp-aggregated code generation for `atomic_rmw`
+ *
+ * When the old values are not used and the pointer is uniform along
+ * some axes (e.g., broadcast rows of a histogram or of a split-K
+ * reduction), elements that target the same address are combined in
+ * registers -- within threads, then across lanes with shuffles -- so
+ * that a single atomic is issued per address and per warp.
+ * Returns false when this does not apply.
+ */
+bool generator::visit_aggregated_atomic_rmw(ir::atomic_rmw_inst *atom) {
+  ir::value* ptr = atom->get_operand(0);
+  ir::value* val = atom->get_operand(1);
+  ir::value* msk = atom->get_operand(2);
+  if(!atom->get_type()->is_block_ty() || !atom->get_users().empty())
+    return false;
+  analysis::scanline_layout* layout = layouts_->get(ptr)->to_scanline();
+  if(!layout)
+    return false;
+  auto shapes = ptr->get_type()->get_block_shapes();
+  std::vector<unsigned> constancy = alignment_->constancy(ptr);
+  std::vector<int> uniform;
+  for(size_t d = 0; d < shapes.size(); d++)
+    if(shapes[d] > 1 && constancy[d] >= shapes[d])
+      uniform.push_back(d);
+  if(uniform.empty())
+    return false;
+  // combination and identity
+  using tt = ir::atomic_rmw_op_t;
+  tt op = atom->get_op();
+  Type *ty = cvt(val->get_type()->get_scalar_ty());
+  if(op == tt::FAdd && !ty->isFloatingPointTy())
+    return false;
+  auto combine = [&](Value *x, Value *y) -> Value* {
+    switch(op){
+      case tt::Or: return or_(x, y);
+      case tt::And: return and_(x, y);
+      case tt::Xor: return xor_(x, y);
+      case tt::Add: return add(x, y);
+      case tt::Min: return select(icmp_slt(x, y), x, y);
+      case tt::Max: return select(icmp_sgt(x, y), x, y);
+      case tt::UMin: return select(icmp_ult(x, y), x, y);
+      case tt::UMax: return select(icmp_ugt(x, y), x, y);
+      case tt::FAdd: return fadd(x, y);
+    }
+    throw std::runtime_error("unreachable");
+  };
+  Value *identity;
+  unsigned nbits = ty->getScalarSizeInBits();
+  switch(op){
+    case tt::And:
+    case tt::UMin: identity = ConstantInt::get(ty, APInt::getAllOnesValue(nbits)); break;
+    case tt::Min: identity = ConstantInt::get(ty, APInt::getSignedMaxValue(nbits)); break;
+    case tt::Max: identity = ConstantInt::get(ty, APInt::getSignedMinValue(nbits)); break;
+    case tt::FAdd: identity = ConstantFP::getNegativeZero(ty); break;
+    default: identity = ConstantInt::get(ty, 0); break;
+  }
+
+  // combine within thread; masked-out elements contribute the identity
+  std::map<indices_t, Value*> accs;
+  std::map<indices_t, Value*> preds;
+  std::map<indices_t, Value*> ptrs;
+  for(indices_t idx: idxs_.at(val)){
+    indices_t key = idx;
+    for(int d: uniform)
+      key[d] = i32(0);
+    Value *pred = vals_[msk][idx];
+    Value *current = select(pred, vals_[val][idx], identity);
+    if(accs.find(key) == accs.end()){
+      accs[key] = current;
+      preds[key] = pred;
+      ptrs[key] = vals_[ptr][idx];
+    }
+    else{
+      accs[key] = combine(accs[key], current);
+      preds[key] = or_(preds[key], pred);
+    }
+    vals_[atom][idx] = UndefValue::get(ty);
+  }
+  std::vector<indices_t> keys;
+  std::vector<Value*> partial;
+  std::vector<Value*> partial_pred;
+  for(auto& acc: accs){
+    keys.push_back(acc.first);
+    partial.push_back(acc.second);
+    partial_pred.push_back(preds.at(acc.first));
+  }
+
+  // combine across lanes; the first lane along each uniform axis issues
+  // the atomic. Threads along the last dimension are not wrapped around
+  // and those beyond `mts` hold replicated data
+  Value *is_leader = builder_->getTrue();
+  for(int d: uniform){
+    int stride = layout->thread_stride(d);
+    for(int i = stride; i < std::min(stride * layout->mts(d), 32); i <<= 1){
+      std::vector<Value*> other = shfl_bfly(partial, i);
+      std::vector<Value*> other_pred = shfl_bfly(partial_pred, i);
+      for(size_t k = 0; k < partial.size(); k++){
+        partial[k] = combine(partial[k], other[k]);
+        partial_pred[k] = or_(partial_pred[k], other_pred[k]);
+      }
+    }
+    Value *thread = axes_.at(a_axes_->get(ptr, d)).thread_id;
+    int num_lanes = layout->mts(d) / layout->warps_along(d);
+    is_leader = and_(is_leader, icmp_eq(urem(thread, i32(num_lanes)), i32(0)));
+  }
+  int last = layout->get_order().back();
+  Value *last_thread = axes_.at(a_axes_->get(ptr, last)).thread_id;
+  is_leader = and_(is_leader, icmp_ult(last_thread, i32(layout->mts(last))));
+  for(size_t k = 0; k < keys.size(); k++)
+    atomic_rmw_asm(op, and_(partial_pred[k], is_leader), ptrs.at(keys[k]), partial[k]);
+  return true;
+}
+
 /**
  * \brief Code Generation for `atomic_add`
  */
@@ -952,13 +1581,16 @@ void generator::visit_atomic_rmw_inst(ir::atomic_rmw_inst *atom) {
   ir::value* val = atom->get_operand(1);
   ir::value* msk = atom->get_operand(2);
 
+  if(visit_aggregated_atomic_rmw(atom))
+    return;
+
   // vector size
   int vec = 1;
   if(atom->get_type()->is_block_ty()){
     int ld = ords_.at(ptr)[0];
-    unsigned alignment = alignment_->get(ptr, ld);
-    vec = std::min<int>(layouts_->get(ptr)->to_scanline()->nts(ld), alignment);
-    vec = std::min(vec, val->get_type()->get_tile_element_ty()->is_fp16_ty() ? 2 : 1);
+    int nts = layouts_->get(ptr)->to_scanline()->nts(ld);
+    nts = std::min(nts, val->get_type()->get_tile_element_ty()->is_fp16_ty() ? 2 : 1);
+    vec = vector_width(atom, ptr, ld, nts);
   }
 
   for(int i = 0; i < idxs_.at(val).size(); i += vec){
@@ -970,55 +1602,15 @@ void generator::visit_atomic_rmw_inst(ir::atomic_rmw_inst *atom) {
     Value *rmw_msk = vals_[msk][idx];
     if(vec == 1)
       rmw_val = extract_elt(rmw_val, i32(0));
-    Type* ty = rmw_val->getType();
-    size_t nbits = ty->getScalarSizeInBits();
-    // extract pointer offset
-    std::string offset = "";
-    if(GetElementPtrInst *gep = dyn_cast<GetElementPtrInst>(rmw_ptr))
-    if(gep->getNumIndices() == 1)
-    if(ConstantInt *cst = dyn_cast<ConstantInt>(gep->idx_begin())){
-      offset = " + " + std::to_string(cst->getValue().getSExtValue()*nbits/8);
-      rmw_ptr = gep->getPointerOperand();
-    }
-    rmw_ptr = bit_cast(rmw_ptr, ty->getPointerTo(1));
-    // asm argument type
-    std::vector<Type*> arg_ty = {rmw_msk->getType(), rmw_ptr->getType(), rmw_val->getType()};
-    // asm function type
-    FunctionType *fn_ty = FunctionType::get(ty, arg_ty, false);
-    // asm string
-    std::string s_nbits = std::to_string(nbits);
-    std::string name;
-    std::string s_ty;
-    using tt = ir::atomic_rmw_op_t;
-    switch(atom->get_op()){
-      case tt::Or: name = "or"; s_ty = "b"; break;
-      case tt::And: name = "and"; s_ty = "b"; break;
-      case tt::Xor: name = "xor", s_ty = "b"; break;
-      case tt::Add: name = "add" , s_ty = "s"; break;
-      case tt::Min: name = "min", s_ty = "s"; break;
-      case tt::Max: name = "max", s_ty = "s"; break;
-      case tt::UMin: name = "min", s_ty = "u"; break;
-      case tt::UMax: name = "max", s_ty = "u"; break;
-      case tt::FAdd: name = "add", s_ty = "f"; break;
-    }
-    std::string s_vec = vec == 2 ? "x2" : "";
-    std::string mod = nbits == 32 ? "" : ".noftz";
-
-    std::string asm_str = "@$1 atom.global.gpu." + name + mod + "." + s_ty + s_nbits + s_vec + " $0, [$2" + offset + "], $3;";
-    std::string ty_id = nbits*vec == 32 ? "r" : "h";
-    std::string constraint = "=" + ty_id + ",b,l," + ty_id;
-    // create inline asm
-    InlineAsm *iasm = InlineAsm::get(fn_ty, asm_str, constraint, true);
-    // call asm
     if(atom->get_type()->is_block_ty())
-      vals_[atom][idx] = call(iasm, (ArrayRef<Value*>{rmw_msk, rmw_ptr, rmw_val}));
+      vals_[atom][idx] = atomic_rmw_asm(atom->get_op(), rmw_msk, rmw_ptr, rmw_val);
     else{
       Module *mod = builder_->GetInsertBlock()->getModule();
       tgt_->add_memfence(mod, *builder_);
       add_barrier();
       Value *tid = tgt_->get_local_id(mod, *builder_, 0);
       rmw_msk = builder_->CreateAnd(rmw_msk, icmp_eq(tid, i32(0)));
-      Value *old = call(iasm, (ArrayRef<Value*>{rmw_msk, rmw_ptr, rmw_val}));
+      Value *old = atomic_rmw_asm(atom->get_op(), rmw_msk, rmw_ptr, rmw_val);
       Value *atom_ptr;
       atom_ptr = gep(shmem_, i32(alloc_->offset(layouts_->get(layouts_->tmp(atom)))), "");
       atom_ptr = bit_cast(atom_ptr, ptr_ty(old->getType(), 3));
@@ -1332,20 +1924,29 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   int stride_b1 = is_b_row ? stride_b_k : stride_b_n;
   int lda = is_a_row ? stride_a_m : stride_a_k;
   int ldb = is_b_row ? stride_b_k : stride_b_n;
+  // number of elements in the 16 bytes of an ldmatrix row: fragments along K
+  // are twice as long for int8 operands and half as long for tf32 ones as
+  // for fp16 ones
+  int dtsize = A->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
+  int k_half = 16 / dtsize;
+  bool is_int8 = dtsize == 1;
+  bool is_tf32 = dtsize == 4;
   int per_phase_a = swizzle_->get_per_phase(layout_a);
   int max_phase_a = swizzle_->get_max_phase(layout_a);
   int per_phase_b = swizzle_->get_per_phase(layout_b);
   int max_phase_b = swizzle_->get_max_phase(layout_b);
   int num_ptr_a   = 8;
   int num_ptr_b   = 8;
-  int vec_a = 8;
-  int vec_b = 8;
+  int vec_a = swizzle_->get_vec(layout_a);
+  int vec_b = swizzle_->get_vec(layout_b);
 
-  Type *fp32_ty = f32_ty;
-  Type *fp16x2_ty = vec_ty(f16_ty, 2);
+  // int8 fragments pack 4 values in a 32-bit register and accumulate in int32,
+  // tf32 fragments hold one value per register
+  Type *fp32_ty = is_int8 ? i32_ty : f32_ty;
+  Type *fp16x2_ty = (is_int8 || is_tf32) ? (Type*)i32_ty : vec_ty(f16_ty, 2);
   Type *fp16x2_pack4_ty = StructType::get(*ctx_, std::vector<llvm::Type*>{fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty});
   Type *fp32_pack4_ty = StructType::get(*ctx_, std::vector<llvm::Type*>{fp32_ty, fp32_ty, fp32_ty, fp32_ty});
-  FunctionType *ld_x4_ty = FunctionType::get(fp16x2_pack4_ty, std::vector<llvm::Type*>{ptr_ty(f16_ty, 3)}, false);
+  FunctionType *ld_x4_ty = FunctionType::get(fp16x2_pack4_ty, std::vector<llvm::Type*>{shmems_[A]->getType()}, false);
 
   // left-hand-side values
   std::map<std::pair<unsigned, unsigned>, std::pair<Value*, Value*>> ha;
@@ -1367,14 +1968,14 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   Value *phase_a = urem(udiv(tidr8, i32(per_phase_a)), i32(max_phase_a));
   Value* off_a0   = mul(tidr8, i32(lda));
   Value *off_am  = mul(add(urem(udiv(lane, i32(8)), i32(2)), mul(warp0, i32(2))), i32(8));
-  Value *off_ak  = mul(udiv(lane, i32(16)), i32(8));
+  Value *off_ak  = mul(udiv(lane, i32(16)), i32(k_half));
   off_am = urem(off_am, i32(shape_a[0]));
   off_ak = urem(off_ak, i32(shape_a[1]));
   off_a0 = add(off_a0, is_a_row ? off_ak : off_am);
   Value* off_a1 = is_a_row ? off_am : off_ak;
   std::vector<Value*> off_a(num_ptr_a);
   for(int i = 0; i < num_ptr_a; i++){
-    Value* off_a0i = add(off_a0, i32(i*16*(is_a_row?1:layout->wpt(0))));
+    Value* off_a0i = add(off_a0, i32(is_a_row ? i*2*k_half : i*16*layout->wpt(0)));
     off_a0i = exact_udiv(off_a0i, i32(vec_a));
     off_a0i = xor_(off_a0i, phase_a);
     off_a0i = mul(off_a0i, i32(vec_a));
@@ -1384,14 +1985,14 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   Value *phase_b = urem(udiv(tidr8, i32(per_phase_b)), i32(max_phase_b));
   Value* off_b0   = mul(tidr8, i32(ldb));
   Value *off_bn  = mul(add(mul(udiv(lane, i32(16)), i32(layout->wpt(1))), mul(warp1, i32(1))), i32(8));
-  Value *off_bk  = mul(urem(udiv(lane, i32(8)), i32(2)), i32(8));
+  Value *off_bk  = mul(urem(udiv(lane, i32(8)), i32(2)), i32(k_half));
   off_bn = urem(off_bn, i32(shape_b[1]));
   off_bk = urem(off_bk, i32(shape_b[0]));
   off_b0 = add(off_b0, is_b_row ? off_bn : off_bk);
   Value* off_b1 = is_b_row ? off_bk : off_bn;
   std::vector<Value*> off_b(num_ptr_b);
   for(int i = 0; i < num_ptr_b; i++){
-    Value* off_b0i = add(off_b0, i32(i*(is_b_row?8*layout->wpt(1):16)));
+    Value* off_b0i = add(off_b0, i32(is_b_row ? i*8*layout->wpt(1) : i*2*k_half));
     off_b0i = exact_udiv(off_b0i, i32(vec_b));
     off_b0i = xor_(off_b0i, phase_b);
     off_b0i = mul(off_b0i, i32(vec_b));
@@ -1409,12 +2010,33 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
     ptrs_b[i] = gep(shmems_[B], {off_b[i]});
 
   FunctionType *mma_ty = FunctionType::get(fp32_pack4_ty, std::vector<llvm::Type*>{fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp16x2_ty, fp32_ty, fp32_ty, fp32_ty, fp32_ty}, false);
-  InlineAsm *mma_fn = InlineAsm::get(mma_ty, "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32 "
+  std::string mma_shape = is_int8 ? "m16n8k32.row.col.s32.s8.s8.s32 " :
+                          is_tf32 ? "m16n8k8.row.col.f32.tf32.tf32.f32 " :
+                                    "m16n8k16.row.col.f32.f16.f16.f32 ";
+  std::string acc_cst = is_int8 ? "=r,=r,=r,=r" : "=f,=f,=f,=f";
+  InlineAsm *mma_fn = InlineAsm::get(mma_ty, "mma.sync.aligned." + mma_shape +
                                              "{$0, $1, $2, $3}, "
                                              "{$4, $5, $6, $7}, "
                                              "{$8, $9}, "
                                              "{$10, $11, $12, $13};",
-                                             "=f,=f,=f,=f,r,r,r,r,r,r,0,1,2,3", true);
+                                             acc_cst + ",r,r,r,r,r,r,0,1,2,3", true);
+  // fp32 values are rounded to nearest rather than truncated by the mma
+  FunctionType *cvt_tf32_ty = FunctionType::get(i32_ty, {i32_ty}, false);
+  InlineAsm *cvt_tf32_fn = InlineAsm::get(cvt_tf32_ty, "cvt.rna.tf32.f32 $0, $1;", "=r,r", false);
+  auto frag = [&](Value *pack, unsigned i) -> Value* {
+    Value *ret = extract_val(pack, std::vector<unsigned>{i});
+    return is_tf32 ? call(cvt_tf32_ty, cvt_tf32_fn, {ret}) : ret;
+  };
+  // sm75 has ldmatrix but no m16n8k16 instruction: the k16 step is split into
+  // two m16n8k8 mmas, whose fragments are exactly the two halves of the k16 ones
+  bool split_k = tgt_->as_nvidia()->sm() < 80;
+  FunctionType *mma_k8_ty = FunctionType::get(fp32_pack4_ty, std::vector<llvm::Type*>{fp16x2_ty, fp16x2_ty, fp16x2_ty, fp32_ty, fp32_ty, fp32_ty, fp32_ty}, false);
+  InlineAsm *mma_k8_fn = InlineAsm::get(mma_k8_ty, "mma.sync.aligned.m16n8k8.row.col.f32.f16.f16.f32 "
+                                                   "{$0, $1, $2, $3}, "
+                                                   "{$4, $5}, "
+                                                   "{$6}, "
+                                                   "{$7, $8, $9, $10};",
+                                                   "=f,=f,=f,=f,r,r,r,0,1,2,3", true);
 
   unsigned num_rep_0 = shapes[0] / layout->spt(0);
   unsigned num_rep_1 = shapes[1] / layout->spt(1);
@@ -1428,9 +2050,19 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
         (m*2 + 1) + (n*2 + 0)*cols_per_thread,
         (m*2 + 1) + (n*2 + 1)*cols_per_thread
       };
-      Value *nc = call(mma_ty, mma_fn, {ha[{m, K}].first, ha[{m, K}].second,ha[{m, K+8}].first, ha[{m, K+8}].second,
-                                                        hb[{n, K}], hb[{n, K+8}],
-                                                        fc[idx[0]], fc[idx[1]], fc[idx[2]], fc[idx[3]]});
+      unsigned K1 = K + k_half;
+      Value *nc;
+      if(split_k){
+        nc = call(mma_k8_ty, mma_k8_fn, {ha[{m, K}].first, ha[{m, K}].second, hb[{n, K}],
+                                         fc[idx[0]], fc[idx[1]], fc[idx[2]], fc[idx[3]]});
+        nc = call(mma_k8_ty, mma_k8_fn, {ha[{m, K1}].first, ha[{m, K1}].second, hb[{n, K1}],
+                                         extract_val(nc, std::vector<unsigned>{0}), extract_val(nc, std::vector<unsigned>{1}),
+                                         extract_val(nc, std::vector<unsigned>{2}), extract_val(nc, std::vector<unsigned>{3})});
+      }
+      else
+        nc = call(mma_ty, mma_fn, {ha[{m, K}].first, ha[{m, K}].second,ha[{m, K1}].first, ha[{m, K1}].second,
+                                   hb[{n, K}], hb[{n, K1}],
+                                   fc[idx[0]], fc[idx[1]], fc[idx[2]], fc[idx[3]]});
       fc[idx[0]] = extract_val(nc, std::vector<unsigned>{0});
       fc[idx[1]] = extract_val(nc, std::vector<unsigned>{1});
       fc[idx[2]] = extract_val(nc, std::vector<unsigned>{2});
@@ -1442,7 +2074,7 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
 
   auto register_lds =
     [&](decltype(ha)& vals, int m, int K, int inc, Value* val0, Value *val1, bool is_prefetch) {
-      if (K <= 8 && is_prefetch) {
+      if (K <= k_half && is_prefetch) {
         ir::basic_block* inc_block = phiA->get_incoming_block(inc);
         lazy_phi_incs_.push_back(std::make_tuple((PHINode*)vals[{m, K}].first, val0, inc_block));
         lazy_phi_incs_.push_back(std::make_tuple((PHINode*)vals[{m, K}].second, val1, inc_block));
@@ -1452,7 +2084,7 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
 
   auto register_lds2 =
     [&](decltype(hb)& vals, int m, int K, int inc, Value* val, bool is_prefetch) {
-      if (K <= 8 && is_prefetch) {
+      if (K <= k_half && is_prefetch) {
         ir::basic_block* inc_block = phiA->get_incoming_block(inc);
         lazy_phi_incs_.push_back(std::make_tuple((PHINode*)vals[{m, K}], val, inc_block));
       } else
@@ -1460,7 +2092,7 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
   };
 
   auto load_a = [&](int m, int K, int inc, bool is_prefetch) {
-      int offidx = (is_a_row ? K/16 : m) % num_ptr_a;
+      int offidx = (is_a_row ? K/(2*k_half) : m) % num_ptr_a;
       Value* ptra;
       if(K == 0 && is_prefetch){
         if(inc == 0)
@@ -1471,24 +2103,24 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
       else
         ptra = ptrs_a[offidx];
       int step_am = is_a_row ? m : m / (num_ptr_a)*(num_ptr_a);
-      int step_ak = is_a_row ? K / (num_ptr_a*16)*(num_ptr_a*16) : K;
+      int step_ak = is_a_row ? K / (num_ptr_a*2*k_half)*(num_ptr_a*2*k_half) : K;
       InlineAsm *ld_a0_fn = InlineAsm::get(ld_x4_ty, "ldmatrix.sync.aligned.m8n8.x4" + a_trans + ".shared.b16 "
                                                 "{$0, $1, $2, $3}, [$4 + " +
-                                                std::to_string(2*step_am*16*layout->wpt(0)*stride_a_m + 2*step_ak*stride_a_k) + "];",
+                                                std::to_string(dtsize*(step_am*16*layout->wpt(0)*stride_a_m + step_ak*stride_a_k)) + "];",
                                                 "=r,=r,=r,=r,r", true);
       Value *haa = call(ld_x4_ty, ld_a0_fn, {ptra});
       if(K == 0 && inc == 1 && is_prefetch)
           prefetch_latch_to_bb_[phiA->get_incoming_value(1)].push_back(haa);
-      Value *ha0 = extract_val(haa, std::vector<unsigned>{0});
-      Value *ha1 = extract_val(haa, std::vector<unsigned>{1});
-      Value *ha2 = extract_val(haa, std::vector<unsigned>{2});
-      Value *ha3 = extract_val(haa, std::vector<unsigned>{3});
+      Value *ha0 = frag(haa, 0);
+      Value *ha1 = frag(haa, 1);
+      Value *ha2 = frag(haa, 2);
+      Value *ha3 = frag(haa, 3);
       register_lds(ha, m, K, inc, ha0, ha1, is_prefetch);
-      register_lds(ha, m, K + 8, inc, ha2, ha3, is_prefetch);
+      register_lds(ha, m, K + k_half, inc, ha2, ha3, is_prefetch);
   };
 
   auto load_b = [&](int n, int K, int inc, bool is_prefetch) {
-      int offidx = (is_b_row ? n : K/16) % num_ptr_b;
+      int offidx = (is_b_row ? n : K/(2*k_half)) % num_ptr_b;
       Value* ptrb;
       if(K == 0 && is_prefetch){
         if(inc == 0)
@@ -1499,22 +2131,22 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
       else
         ptrb = ptrs_b[offidx];
       int step_bn = is_b_row ? n / (num_ptr_b)*(num_ptr_b) : n;
-      int step_bk = is_b_row ? K : K / (num_ptr_b*8)*(num_ptr_b*8);
+      int step_bk = is_b_row ? K : K / (num_ptr_b*2*k_half)*(num_ptr_b*2*k_half);
       InlineAsm *ld_b_fn = InlineAsm::get(ld_x4_ty, "ldmatrix.sync.aligned.m8n8.x4" + b_trans + ".shared.b16 "
                                                     "{$0, $1, $2, $3}, [$4 + " +
-                                                    std::to_string(2*step_bn*8*layout->wpt(1)*stride_b_n + 2*step_bk*stride_b_k) + "];",
+                                                    std::to_string(dtsize*(step_bn*8*layout->wpt(1)*stride_b_n + step_bk*stride_b_k)) + "];",
                                                     "=r,=r,=r,=r,r", true);
       Value *hbb = call(ld_x4_ty, ld_b_fn, {ptrb});
       if(K == 0 && inc == 1 && is_prefetch)
           prefetch_latch_to_bb_[phiB->get_incoming_value(1)].push_back(hbb);
-      Value *hb0 = extract_val(hbb, std::vector<unsigned>{0});
-      Value *hb1 = extract_val(hbb, std::vector<unsigned>{1});
-      Value *hb2 = extract_val(hbb, std::vector<unsigned>{2});
-      Value *hb3 = extract_val(hbb, std::vector<unsigned>{3});
+      Value *hb0 = frag(hbb, 0);
+      Value *hb1 = frag(hbb, 1);
+      Value *hb2 = frag(hbb, 2);
+      Value *hb3 = frag(hbb, 3);
       register_lds2(hb, n, K, inc, hb0, is_prefetch);
       register_lds2(hb, n+1, K, inc, hb2, is_prefetch);
-      register_lds2(hb, n, K+8, inc, hb1, is_prefetch);
-      register_lds2(hb, n+1, K+8, inc, hb3, is_prefetch);
+      register_lds2(hb, n, K+k_half, inc, hb1, is_prefetch);
+      register_lds2(hb, n+1, K+k_half, inc, hb3, is_prefetch);
   };
 
   if (C->is_prefetched()) {
@@ -1523,14 +2155,14 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
       for(unsigned m = 0; m < num_rep_0; m++){
         ha[{m, 0}].first = phi(fp16x2_ty, 2);
         ha[{m, 0}].second = phi(fp16x2_ty, 2);
-        ha[{m, 8}].first = phi(fp16x2_ty, 2);
-        ha[{m, 8}].second = phi(fp16x2_ty, 2);
+        ha[{m, k_half}].first = phi(fp16x2_ty, 2);
+        ha[{m, k_half}].second = phi(fp16x2_ty, 2);
       }
       for(unsigned n = 0; n < num_rep_1; n+=2){
         hb[{n, 0}] = phi(fp16x2_ty, 2);
         hb[{n+1, 0}] = phi(fp16x2_ty, 2);
-        hb[{n, 8}] = phi(fp16x2_ty, 2);
-        hb[{n+1, 8}] = phi(fp16x2_ty, 2);
+        hb[{n, k_half}] = phi(fp16x2_ty, 2);
+        hb[{n+1, k_half}] = phi(fp16x2_ty, 2);
       }
       // insert prefetched lds at the end of loop header
       builder_->SetInsertPoint(bbs_[phiA->get_incoming_block(0)]->getTerminator());
@@ -1540,8 +2172,8 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
         load_b(n, 0, 0, true);
       // update accumulators
       builder_->SetInsertPoint(CurrBB);
-      for(unsigned K = 0; K < NK; K += 16){
-        int NEXTK = (K + 16) % NK;
+      for(unsigned K = 0; K < NK; K += 2*k_half){
+        int NEXTK = (K + 2*k_half) % NK;
         // prefetch A
         for(unsigned m = 0; m < num_rep_0; m++)
           load_a(m, NEXTK, 1, true);
@@ -1556,7 +2188,7 @@ void generator::visit_mma16816(ir::dot_inst* C, ir::value *A, ir::value *B, ir::
       }
   }
   else{
-      for(unsigned K = 0; K < NK; K += 16)
+      for(unsigned K = 0; K < NK; K += 2*k_half)
       for(unsigned m = 0; m < num_rep_0; m++)
       for(unsigned n = 0; n < num_rep_1; n++){
         if(ha.find({m, K}) == ha.end())
@@ -1609,8 +2241,8 @@ void generator::visit_fmadot(ir::dot_inst* C, ir::value* A, ir::value* B, ir::va
   int max_phase_b = swizzle_->get_max_phase(layout_b);
   int num_ptr_a   = 8;
   int num_ptr_b   = 8;
-  int vec_a = 2;
-  int vec_b = 4;
+  int vec_a = swizzle_->get_vec(layout_a);
+  int vec_b = swizzle_->get_vec(layout_b);
   distributed_axis ax_m = axes_.at(a_axes_->get(C, 0));
   distributed_axis ax_n = axes_.at(a_axes_->get(C, 1));
 //  Value* thread = tgt_->get_local_id(mod_, *builder_, 0);
@@ -1642,9 +2274,56 @@ void generator::visit_fmadot(ir::dot_inst* C, ir::value* A, ir::value* B, ir::va
   for(int i = 0; i < num_ptr_b; i++)
     ptrs_b[i] = gep(shmems_[B], off_b[i]);
 
+  // int8 products are accumulated 4 at a time along K with dp4a, other
+  // integer products with a plain multiply-add
+  bool is_int = c_ty->isIntegerTy();
+  bool is_int8 = A->get_type()->get_scalar_ty()->is_integer_ty(8) &&
+                 B->get_type()->get_scalar_ty()->is_integer_ty(8);
+  bool use_dp4a = is_int && is_int8 && NK % 4 == 0 && tgt_->as_nvidia()->sm() >= 61;
+  unsigned k_step = use_dp4a ? 4 : 1;
+  FunctionType *dp4a_ty = FunctionType::get(i32_ty, {i32_ty, i32_ty, i32_ty}, false);
+  InlineAsm *dp4a_fn = InlineAsm::get(dp4a_ty, "dp4a.s32.s32 $0, $1, $2, $3;", "=r,r,r,r", false);
+  auto pack = [&](const std::vector<Value*>& vals) -> Value* {
+    if(vals.size() == 1)
+      return vals[0];
+    Value *packed = UndefValue::get(vec_ty(vals[0]->getType(), vals.size()));
+    for(size_t i = 0; i < vals.size(); i++)
+      packed = insert_elt(packed, vals[i], i);
+    return bit_cast(packed, i32_ty);
+  };
+  auto mul_add = [&](Value *a, Value *b, Value *c) -> Value* {
+    if(use_dp4a)
+      return call(dp4a_ty, dp4a_fn, {a, b, c});
+    if(is_int)
+      return add(mul(cast(Instruction::SExt, a, c_ty), cast(Instruction::SExt, b, c_ty)), c);
+    return call(f_mul_add, {a, b, c});
+  };
+
+  // operands contiguous along K are read across rows, which are swizzled
+  bool swizzle_a = is_a_row && max_phase_a > 1;
+  bool swizzle_b = !is_b_row && max_phase_b > 1;
+  std::map<int, Value*> phases_a, phases_b;
+  auto swizzled_off = [&](Value *row, int i, int k, int ld, int vec, int per_phase, int max_phase,
+                          std::map<int, Value*>& phases) {
+    if(phases.find(i) == phases.end())
+      phases[i] = urem(udiv(add(row, i32(i)), i32(per_phase)), i32(max_phase));
+    Value *col = add(mul(xor_(i32(k / vec), phases[i]), i32(vec)), i32(k % vec));
+    return add(mul(add(row, i32(i)), i32(ld)), col);
+  };
+  auto load_a = [&](int m, int k) {
+    if(swizzle_a)
+      return load(gep(shmems_[A], swizzled_off(off_a1, m, k, stride_a_m, vec_a, per_phase_a, max_phase_a, phases_a)));
+    return load(gep(ptrs_a[0], i32(m*stride_a_m + k*stride_a_k)));
+  };
+  auto load_b = [&](int n, int k) {
+    if(swizzle_b)
+      return load(gep(shmems_[B], swizzled_off(off_b1, n, k, stride_b_n, vec_b, per_phase_b, max_phase_b, phases_b)));
+    return load(gep(ptrs_b[0], i32(n*stride_b_n + k*stride_b_k)));
+  };
+
   std::map<indices_t, Value*> ret = vals_[D];
   std::map<std::pair<int, int>, Value*> has, hbs;
-  for(unsigned k = 0; k < NK; k++){
+  for(unsigned k = 0; k < NK; k += k_step){
     int z = 0;
     for(unsigned m = 0; m < shape_c[0]; m+=layout_c->mts(0)*layout_c->nts(0))
     for(unsigned n = 0; n < shape_c[1]; n+=layout_c->mts(1)*layout_c->nts(1))
@@ -1652,16 +2331,18 @@ void generator::visit_fmadot(ir::dot_inst* C, ir::value* A, ir::value* B, ir::va
     for(unsigned nn = 0; nn < layout_c->nts(1); nn++)
     {
       if(has.find({m + mm, k}) == has.end()){
-        Value* pa = gep(ptrs_a[0], i32((m + mm)*stride_a_m + k*stride_a_k));
-        Value* va = load(pa);
-        has[{m + mm, k}] = va;
+        std::vector<Value*> va;
+        for(unsigned kk = k; kk < k + k_step; kk++)
+          va.push_back(load_a(m + mm, kk));
+        has[{m + mm, k}] = pack(va);
       }
       if(hbs.find({n + nn, k}) == hbs.end()){
-        Value* pb = gep(ptrs_b[0], i32((n + nn)*stride_b_n + k*stride_b_k));
-        Value* vb = load(pb);
-        hbs[{n + nn, k}] = vb;
+        std::vector<Value*> vb;
+        for(unsigned kk = k; kk < k + k_step; kk++)
+          vb.push_back(load_b(n + nn, kk));
+        hbs[{n + nn, k}] = pack(vb);
       }
-      ret[idxs_[C].at(z)] = call(f_mul_add, {has[{m+mm,k}], hbs[{n+nn, k}], ret[idxs_[C].at(z)]});
+      ret[idxs_[C].at(z)] = mul_add(has[{m+mm,k}], hbs[{n+nn, k}], ret[idxs_[C].at(z)]);
       z++;
     }
   }
@@ -1682,15 +2363,15 @@ void generator::visit_dot_inst(ir::dot_inst* dot) {
   ir::value *B = dot->get_operand(1);
   ir::value *D = dot->get_operand(2);
   Type *c_ty = cvt(D->get_type()->get_scalar_ty());
-  Function *f_mul_add = Intrinsic::getDeclaration(module, Intrinsic::fmuladd, std::vector<llvm::Type*>{c_ty});
+  Function *f_mul_add = c_ty->isFloatingPointTy() ? Intrinsic::getDeclaration(module, Intrinsic::fmuladd, std::vector<llvm::Type*>{c_ty}) : nullptr;
   auto A_shapes = A->get_type()->get_block_shapes();
   size_t red_axis = 1;
   unsigned NK = A_shapes[red_axis];
   bool is_outer = NK == 1;
   bool is_mma = layouts_->get(dot)->to_mma();
-  if(!is_outer && is_mma && tgt_->as_nvidia()->sm() < 80)
+  if(!is_outer && is_mma && tgt_->as_nvidia()->sm() < 75)
     return visit_mma884(dot, A, B, D, NK);
-  if(!is_outer && is_mma && tgt_->as_nvidia()->sm() >= 80)
+  if(!is_outer && is_mma && tgt_->as_nvidia()->sm() >= 75)
     return visit_mma16816(dot, A, B, D, NK);
   return visit_fmadot(dot, A, B, D, NK, c_ty, f_mul_add);
 }
@@ -1724,130 +2405,75 @@ Value* generator::shared_off(const std::vector<unsigned>& shapes, const std::vec
 }
 
 /**
- * \brief Code Generation for `reduce` (1D case)
+ * \brief Warp shuffle of a single value. `mode` is one of up/down/bfly/idx.
+ * Values narrower than 32 bits are zero-extended and 64-bit values are
+ * split, so that every shuffle moves 32 bits
  */
-void generator::visit_reduce1d_inst(ir::reduce_inst* x, std::function<Value*(Value*,Value*)> do_acc, Value *neutral) {
-  std::map<indices_t, Value*> partial;
-  ir::value *arg = x->get_operand(0);
-  Type *ret_ty = cvt(x->get_type()->get_scalar_ty());
-  Value *acc = nullptr;
-
-  // reduce within thread
-  for(indices_t idx: idxs_.at(arg)){
-    Value *val = vals_[arg][idx];
-    acc = !acc ? val : do_acc(acc, val);
-  }
-  // reduce within wrap
-  InlineAsm *shfl = InlineAsm::get(FunctionType::get(ret_ty, {ret_ty, i32_ty}, false),
-                                   "shfl.sync.bfly.b32 $0, $1, $2, 0x1f, 0xffffffff;", "=f,f,r", false);
-  for(int i = 16; i > 0; i >>= 1)
-    acc = do_acc(acc, call(shfl, {acc, i32(i)}));
-  // pointers
-  unsigned addr_space = shmem_->getType()->getPointerAddressSpace();
-  Value *base = bit_cast(shmem_, ptr_ty(ret_ty, addr_space));
-  Value* thread = tgt_->get_local_id(mod_, *builder_, 0);
-  Value* warp = udiv(thread, i32(32));
-  Value* lane = urem(thread, i32(32));
-  // store warp result in shared memory
-  add_barrier();
-  store(neutral, gep(base, lane));
-  add_barrier();
-  store(acc, gep(base, warp));
-  add_barrier();
-
-  // reduce across warps
-  Value *cond = icmp_eq(warp, i32(0));
-  Instruction *barrier = add_barrier();
-  builder_->SetInsertPoint(barrier->getParent());
-  Instruction* dummy = builder_->CreateRet(nullptr);
-  Instruction *term = llvm::SplitBlockAndInsertIfThen(cond, barrier, false);
-  dummy->removeFromParent();
-  builder_->SetInsertPoint(term);
-  Value* ret = load(gep(base, thread));
-  for(int i = (num_warps_+1)/2; i > 0; i >>= 1){
-    Value *current = call(shfl, {ret, i32(i)});
-    ret = do_acc(ret, current);
-  }
-  store(ret, gep(base, thread));
-
-  // store first warp done
-  builder_->SetInsertPoint(barrier->getParent());
-  ret = load(base);
-  for(indices_t idx: idxs_.at(x))
-    vals_[x][idx] = ret;
+Value* generator::shfl_sync(Value *val, const std::string &mode, Value *arg) {
+  // lanes shifted past the start of the warp keep their own value
+  std::string clamp = mode == "up" ? "0x0" : "0x1f";
+  InlineAsm *shfl = InlineAsm::get(FunctionType::get(i32_ty, {i32_ty, i32_ty}, false),
+                                   "shfl.sync." + mode + ".b32 $0, $1, $2, " + clamp + ", 0xffffffff;", "=r,r,r", false);
+  Type *ty = val->getType();
+  unsigned bits = ty->getPrimitiveSizeInBits();
+  if(bits < 32){
+    Type *int_ty = builder_->getIntNTy(bits);
+    Value *word = builder_->CreateZExt(bit_cast(val, int_ty), i32_ty);
+    word = builder_->CreateTrunc(call(shfl, {word, arg}), int_ty);
+    return bit_cast(word, ty);
+  }
+  if(bits == 32)
+    return bit_cast(call(shfl, {bit_cast(val, i32_ty), arg}), ty);
+  unsigned num_words = bits / 32;
+  Value *words = bit_cast(val, vec_ty(i32_ty, num_words));
+  Value *shuffled = UndefValue::get(vec_ty(i32_ty, num_words));
+  for(unsigned w = 0; w < num_words; w++)
+    shuffled = insert_elt(shuffled, call(shfl, {extract_elt(words, (uint64_t)w), arg}), (uint64_t)w);
+  return bit_cast(shuffled, ty);
 }
 
 /**
- * \brief Code Generation for `reduce` (ND case)
+ * \brief Butterfly shuffle of `vals` across lanes `i` apart.
+ * 16-bit values are packed by pairs
  */
-void generator::visit_reducend_inst(ir::reduce_inst* x, std::function<Value*(Value*,Value*)> do_acc, Value *neutral) {
-  ir::value *arg = x->get_operand(0);
-  Type *ty = cvt(x->get_type()->get_scalar_ty());
-  unsigned axis = x->get_axis();
-
-  // reduce within thread
-  std::map<indices_t, Value*> accs;
-  for(indices_t idx: idxs_.at(arg)){
-    indices_t pidx = idx;
-    pidx[axis] = i32(0);
-    Value *current = vals_[arg][idx];
-    bool is_first = accs.find(pidx) == accs.end();
-    accs[pidx] = is_first ? current : do_acc(accs[pidx], current);
-  };
-
-  // reduce within blocks
-  analysis::data_layout* layout = layouts_->get(layouts_->tmp(x));
-  Value *base = shared_ptr_.at(layout);
-  auto shape  = layout->get_shape();
-  auto order  = layout->get_order();
-  int  space = base->getType()->getPointerAddressSpace();
-  Value *ptr = bit_cast(base, ptr_ty(ty, space));
-  Value *lane = axes_.at(a_axes_->get(arg, axis)).thread_id;
-  for(auto& x: accs) {
-    // current element being computed
-    Value *&acc = x.second;
-    indices_t write_idx = x.first;
-    write_idx[axis] = lane;
-    // shared memory write  pointer
-    Value *write_off = shared_off(shape, order, write_idx);
-    Value *write_ptr = gep(ptr, write_off);
-    // initialize shared memory
-    add_barrier();
-    store(acc, write_ptr);
-    // build result
-    indices_t idx(write_idx.size(), i32(0));
-    for(size_t i = shape[axis]/2; i > 0; i >>= 1){
-      idx[axis] = i32(i);
-      // read pointer
-      Value *read_msk = icmp_ult(lane, i32(i));
-      Value *read_off = select(read_msk, shared_off(shape, order, idx), i32(0));
-      Value *read_ptr = gep(write_ptr, read_off);
-      add_barrier();
-      // update accumulator
-      acc = do_acc(acc, load(read_ptr));
-      store(acc, write_ptr);
+std::vector<Value*> generator::shfl_bfly(const std::vector<Value*>& vals, int i) {
+  std::vector<Value*> ret;
+  for(size_t k = 0; k < vals.size(); k++){
+    Type *ty = vals[k]->getType();
+    // 16-bit values of the same type are exchanged in pairs
+    if(ty->getPrimitiveSizeInBits() == 16 && k + 1 < vals.size() && vals[k + 1]->getType() == ty){
+      Value *packed = UndefValue::get(vec_ty(ty, 2));
+      packed = insert_elt(packed, vals[k], (uint64_t)0);
+      packed = insert_elt(packed, vals[k + 1], (uint64_t)1);
+      packed = bit_cast(shfl_sync(bit_cast(packed, i32_ty), "bfly", i32(i)), vec_ty(ty, 2));
+      ret.push_back(extract_elt(packed, (uint64_t)0));
+      ret.push_back(extract_elt(packed, (uint64_t)1));
+      k++;
+      continue;
     }
+    ret.push_back(shfl_sync(vals[k], "bfly", i32(i)));
   }
-  add_barrier();
-
-  // write back
-  for(indices_t idx: idxs_.at(x)){
-    indices_t read_idx = idx;
-    read_idx.insert(read_idx.begin() + axis, i32(0));
-    Value *read_off = shared_off(shape, order, read_idx);
-    Value *read_ptr = gep(ptr, read_off);
-    vals_[x][idx] = load(read_ptr);
-  };
+  return ret;
 }
 
 /**
- * \brief Code Generation for `reduce` (generic case)
+ * \brief Code Generation for `reduce`
+ *
+ * Reductions fused by the layout analysis are emitted together: their
+ * partial results go through the same shuffles, and through the same
+ * shared buffer and barrier across warps.
+ *
+ * Arg-reductions carry (value, index) pairs through the same steps:
+ * each pair is shuffled as two words and combined so that ties and
+ * NaNs resolve the same way regardless of the order of combination
  */
 void generator::visit_reduce_inst(ir::reduce_inst* x) {
-  Type *ty = cvt(x->get_type()->get_scalar_ty());
+  // emitted along with the last reduction of the group
+  if(layouts_->is_fused(x))
+    return;
+  const std::vector<ir::reduce_inst*>& group = layouts_->fused_with(x);
   // accumulation function
-  ir::reduce_inst::op_t op = x->get_op();
-  auto do_acc = [&](Value *x, Value *y) -> Value* {
+  auto do_acc_impl = [&](ir::reduce_inst::op_t op, Value *x, Value *y) -> Value* {
     switch(op){
     case ir::reduce_inst::ADD: return add(x, y);
     case ir::reduce_inst::SUB: return sub(x, y);
@@ -1860,24 +2486,357 @@ void generator::visit_reduce_inst(ir::reduce_inst* x) {
     default: throw std::runtime_error("unreachable");
     }
   };
-  // neutral element
-  Value *neutral;
-  switch(op) {
-    case ir::reduce_inst::ADD: neutral = ConstantInt::get(ty, 0); break;
-    case ir::reduce_inst::SUB:  neutral = ConstantInt::get(ty, 0); break;
-    case ir::reduce_inst::MAX:  neutral = ConstantInt::get(ty, INT32_MIN); break;
-    case ir::reduce_inst::MIN:  neutral = ConstantInt::get(ty, INT32_MAX); break;
-    case ir::reduce_inst::FADD: neutral = ConstantFP::get(ty, 0); break;
-    case ir::reduce_inst::FSUB: neutral = ConstantFP::get(ty, 0); break;
-    case ir::reduce_inst::FMAX: neutral = ConstantFP::get(ty, -INFINITY); break;
-    case ir::reduce_inst::FMIN: neutral = ConstantFP::get(ty, INFINITY); break;
-    default: throw std::runtime_error("unreachable");
+  // bf16 is stored as i16
+  auto is_bf16 = [&](ir::reduce_inst *red) {
+    return red->get_operand(0)->get_type()->get_scalar_ty()->is_bf16_ty();
+  };
+  auto do_acc = [&](ir::reduce_inst *red, Value *x, Value *y) -> Value* {
+    if(is_bf16(red))
+      return fp32_to_bf16(do_acc_impl(red->get_op(), bf16_to_fp32(x), bf16_to_fp32(y)));
+    return do_acc_impl(red->get_op(), x, y);
+  };
+  // whether (y, j) takes precedence over (x, i)
+  auto takes_precedence = [&](ir::reduce_inst *red, Value *x, Value *i, Value *y, Value *j) -> Value* {
+    Value *better, *tie;
+    ir::reduce_inst::op_t op = red->get_op();
+    if(is_bf16(red)){
+      x = bf16_to_fp32(x);
+      y = bf16_to_fp32(y);
+    }
+    if(op == ir::reduce_inst::ARGMAX || op == ir::reduce_inst::ARGMIN){
+      better = op == ir::reduce_inst::ARGMAX ? icmp_sgt(y, x) : icmp_slt(y, x);
+      tie = icmp_eq(y, x);
+    }
+    else{
+      // NaNs win, and tie with each other
+      Value *x_nan = fcmp_uno(x, x);
+      Value *y_nan = fcmp_uno(y, y);
+      better = op == ir::reduce_inst::ARGFMAX ? fcmp_ogt(y, x) : fcmp_olt(y, x);
+      better = or_(better, and_(y_nan, not_(x_nan)));
+      tie = or_(fcmp_oeq(y, x), and_(x_nan, y_nan));
+    }
+    return or_(better, and_(tie, icmp_ult(j, i)));
+  };
+  ir::value *arg = x->get_operand(0);
+  unsigned axis = x->get_axis();
+  analysis::scanline_layout* layout = layouts_->get(arg)->to_scanline();
+
+  // reduce within thread. Partial results are indexed by
+  // (reduction, position along the other axes)
+  std::vector<indices_t> keys;
+  std::vector<ir::reduce_inst*> owner;
+  std::vector<Value*> partial;
+  std::vector<Value*> partial_idx;
+  for(ir::reduce_inst *red: group){
+    ir::value *red_arg = red->get_operand(0);
+    bool with_index = red->with_index();
+    std::map<indices_t, Value*> accs;
+    std::map<indices_t, Value*> acc_idxs;
+    for(indices_t idx: idxs_.at(red_arg)){
+      indices_t pidx = idx;
+      pidx[axis] = i32(0);
+      Value *current = vals_[red_arg][idx];
+      auto it = accs.find(pidx);
+      if(it == accs.end()){
+        accs[pidx] = current;
+        acc_idxs[pidx] = idx[axis];
+      }
+      else if(with_index){
+        Value *pred = takes_precedence(red, it->second, acc_idxs[pidx], current, idx[axis]);
+        accs[pidx] = select(pred, current, it->second);
+        acc_idxs[pidx] = select(pred, idx[axis], acc_idxs[pidx]);
+      }
+      else
+        accs[pidx] = do_acc(red, it->second, current);
+    }
+    if(keys.empty())
+      for(auto& acc: accs)
+        keys.push_back(acc.first);
+    for(const indices_t& key: keys){
+      owner.push_back(red);
+      partial.push_back(accs.at(key));
+      partial_idx.push_back(acc_idxs.at(key));
+    }
+  }
+  auto combine = [&](size_t k, Value *other, Value *other_idx) {
+    ir::reduce_inst *red = owner[k];
+    if(!red->with_index()){
+      partial[k] = do_acc(red, partial[k], other);
+      return;
+    }
+    Value *pred = takes_precedence(red, partial[k], partial_idx[k], other, other_idx);
+    partial[k] = select(pred, other, partial[k]);
+    partial_idx[k] = select(pred, other_idx, partial_idx[k]);
+  };
+
+  // reduce within warp; indices of arg-reductions are shuffled
+  // along with the values
+  int stride = layout->thread_stride(axis);
+  for(int i = stride; i < std::min(stride * layout->mts(axis), 32); i <<= 1){
+    std::vector<Value*> words = partial;
+    for(size_t k = 0; k < partial.size(); k++)
+      if(owner[k]->with_index())
+        words.push_back(partial_idx[k]);
+    std::vector<Value*> other = shfl_bfly(words, i);
+    for(size_t k = 0, n = partial.size(); k < partial.size(); k++)
+      combine(k, other[k], owner[k]->with_index() ? other[n++] : nullptr);
+  }
+
+  // reduce across warps
+  int num_warps = layout->warps_along(axis);
+  if(num_warps > 1){
+    analysis::shared_layout* tmp = layouts_->get(layouts_->tmp(x))->to_shared();
+    // partial results are stored as words. Reduction `r` of the group
+    // owns slots [offset(r) * num_warps, (offset(r) + 1) * num_warps)
+    // along `axis`, and arg-reductions store their indices in the next
+    // `num_warps` slots
+    Type *word_ty = cvt(tmp->get_type());
+    auto to_word = [&](Value *v) {
+      if(v->getType() == word_ty)
+        return v;
+      Value *bits = bit_cast(v, builder_->getIntNTy(v->getType()->getPrimitiveSizeInBits()));
+      return builder_->CreateZExtOrTrunc(bits, word_ty);
+    };
+    auto from_word = [&](Value *w, Type *dst) {
+      if(dst == word_ty)
+        return w;
+      return bit_cast(builder_->CreateTrunc(w, builder_->getIntNTy(dst->getPrimitiveSizeInBits())), dst);
+    };
+    std::map<ir::reduce_inst*, int> offset;
+    int num_words = 0;
+    for(ir::reduce_inst *red: group){
+      offset[red] = num_words;
+      num_words += red->with_index() ? 2 : 1;
+    }
+    Value *base = bit_cast(shared_ptr_.at(tmp), ptr_ty(word_ty, shmem_->getType()->getPointerAddressSpace()));
+    auto shape = tmp->get_shape();
+    auto order = tmp->get_order();
+    Value *thread = axes_.at(a_axes_->get(arg, axis)).thread_id;
+    Value *warp = udiv(thread, i32(layout->mts(axis) / num_warps));
+    auto slot = [&](size_t k, int word, Value *w) {
+      indices_t idx = keys[k % keys.size()];
+      idx[axis] = add(w, i32((offset.at(owner[k]) + word) * num_warps));
+      return gep(base, shared_off(shape, order, idx));
+    };
+    // scalar results are not tracked by membar
+    bool is_scalar = !x->get_type()->is_block_ty();
+    if(is_scalar)
+      add_barrier();
+    // thread ids along the last dimension are not wrapped around:
+    // threads beyond `mts` hold replicated (out-of-bounds) data
+    BasicBlock *done = nullptr;
+    int num_threads = 1;
+    for(size_t d = 0; d < layout->get_rank(); d++)
+      num_threads *= layout->mts(d);
+    if(layout->get_order().back() == (int)axis && num_threads < (int)num_warps_*32){
+      BasicBlock *current = builder_->GetInsertBlock();
+      BasicBlock *write_bb = BasicBlock::Create(*ctx_, "reduce_write", current->getParent());
+      done = BasicBlock::Create(*ctx_, "reduce_write_done", current->getParent());
+      cond_br(icmp_ult(thread, i32(layout->mts(axis))), write_bb, done);
+      builder_->SetInsertPoint(write_bb);
+    }
+    for(size_t k = 0; k < partial.size(); k++){
+      store(to_word(partial[k]), slot(k, 0, warp));
+      if(owner[k]->with_index())
+        store(to_word(partial_idx[k]), slot(k, 1, warp));
+    }
+    if(done){
+      br(done);
+      builder_->SetInsertPoint(done);
+    }
+    add_barrier();
+    for(size_t k = 0; k < partial.size(); k++){
+      Type *ty = partial[k]->getType();
+      bool with_index = owner[k]->with_index();
+      for(int w = 0; w < num_warps; w++){
+        Value *current = from_word(load(slot(k, 0, i32(w))), ty);
+        Value *current_idx = nullptr;
+        if(with_index)
+          current_idx = from_word(load(slot(k, 1, i32(w))), i32_ty);
+        if(w == 0){
+          partial[k] = current;
+          partial_idx[k] = current_idx;
+        }
+        else
+          combine(k, current, current_idx);
+      }
+    }
+    if(is_scalar)
+      add_barrier();
+  }
+
+  // write back
+  for(size_t m = 0; m < group.size(); m++){
+    ir::reduce_inst *red = group[m];
+    std::map<indices_t, Value*> results;
+    for(size_t k = 0; k < keys.size(); k++)
+      results[keys[k]] = red->with_index() ? partial_idx[m*keys.size() + k] : partial[m*keys.size() + k];
+    for(indices_t idx: idxs_.at(red)){
+      indices_t pidx = idx;
+      pidx.insert(pidx.begin() + axis, i32(0));
+      vals_[red][idx] = results.at(pidx);
+    }
   }
+}
+
+/**
+ * \brief Code Generation for `scan`
+ *
+ * Along `axis`, each thread owns `nts` contiguous elements per repetition
+ * of the layout. Every repetition is scanned sequentially within threads,
+ * then across the lanes of each warp (Hillis-Steele with shfl.up); warp
+ * totals of all repetitions go through shared memory at once, so that a
+ * single barrier is needed regardless of the size of the block.
+ */
+void generator::visit_scan_inst(ir::scan_inst* x) {
   ir::value *arg = x->get_operand(0);
-  if(arg->get_type()->get_tile_rank() == 1)
-    visit_reduce1d_inst(x, do_acc, neutral);
-  else
-    visit_reducend_inst(x, do_acc, neutral);
+  ir::type *arg_ty = arg->get_type()->get_scalar_ty();
+  unsigned axis = x->get_axis();
+  analysis::scanline_layout* layout = layouts_->get(arg)->to_scanline();
+  if(!layout)
+    throw std::runtime_error("scan: unsupported layout");
+  // bf16 is accumulated in fp32
+  bool is_bf16 = arg_ty->is_bf16_ty();
+  Type *ty = is_bf16 ? f32_ty : cvt(arg_ty);
+  ir::scan_inst::op_t op = x->get_op();
+  auto do_acc = [&](Value *x, Value *y) -> Value* {
+    switch(op){
+    case ir::scan_inst::ADD: return add(x, y);
+    case ir::scan_inst::MAX: return select(icmp_sge(x, y), x, y);
+    case ir::scan_inst::MIN: return select(icmp_sle(x, y), x, y);
+    case ir::scan_inst::FADD: return fadd(x, y);
+    case ir::scan_inst::FMAX: return max_num(x, y);
+    case ir::scan_inst::FMIN: return min_num(x, y);
+    default: throw std::runtime_error("unreachable");
+    }
+  };
+  Value *identity;
+  unsigned bits = ty->getPrimitiveSizeInBits();
+  switch(op){
+  case ir::scan_inst::ADD: identity = ConstantInt::get(ty, 0); break;
+  case ir::scan_inst::MAX: identity = ConstantInt::get(ty, APInt::getSignedMinValue(bits)); break;
+  case ir::scan_inst::MIN: identity = ConstantInt::get(ty, APInt::getSignedMaxValue(bits)); break;
+  case ir::scan_inst::FADD: identity = ConstantFP::get(ty, 0.); break;
+  case ir::scan_inst::FMAX: identity = ConstantFP::getInfinity(ty, true); break;
+  case ir::scan_inst::FMIN: identity = ConstantFP::getInfinity(ty, false); break;
+  default: throw std::runtime_error("unreachable");
+  }
+
+  int nts = layout->nts(axis);
+  int mts = layout->mts(axis);
+  int num_warps = layout->warps_along(axis);
+  int num_lanes = mts / num_warps;
+  int stride = layout->thread_stride(axis);
+  int shape_axis = arg->get_type()->get_block_shapes()[axis];
+  int num_reps = std::max(shape_axis / (nts * mts), 1);
+  Value *thread = axes_.at(a_axes_->get(arg, axis)).thread_id;
+  Value *lane = urem(thread, i32(num_lanes));
+  Value *warp = udiv(thread, i32(num_lanes));
+
+  // group elements by position along the other axes; elements of a
+  // thread along `axis` are ordered by coordinate
+  std::map<indices_t, std::vector<indices_t>> lines;
+  for(indices_t idx: idxs_.at(arg)){
+    indices_t pidx = idx;
+    pidx[axis] = i32(0);
+    lines[pidx].push_back(idx);
+  }
+  // sequential scan of each repetition within thread
+  typedef std::pair<indices_t, int> key_t;
+  std::vector<key_t> keys;
+  std::vector<Value*> totals;
+  std::map<key_t, std::vector<Value*>> local;
+  for(auto& line: lines)
+  for(int r = 0; r*nts < (int)line.second.size(); r++){
+    key_t key = {line.first, r};
+    Value *acc = nullptr;
+    for(int j = 0; j < nts; j++){
+      Value *current = vals_[arg][line.second[r*nts + j]];
+      if(is_bf16)
+        current = bf16_to_fp32(current);
+      acc = acc ? do_acc(acc, current) : current;
+      local[key].push_back(acc);
+    }
+    keys.push_back(key);
+    totals.push_back(acc);
+  }
+
+  // inclusive scan of thread totals within warp, then shift by one lane
+  // to get what precedes each thread
+  for(int d = 1; d < num_lanes; d <<= 1)
+  for(size_t k = 0; k < totals.size(); k++){
+    Value *other = shfl_sync(totals[k], "up", i32(d * stride));
+    totals[k] = select(icmp_uge(lane, i32(d)), do_acc(other, totals[k]), totals[k]);
+  }
+  std::vector<Value*> prefix(totals.size(), identity);
+  if(num_lanes > 1)
+  for(size_t k = 0; k < totals.size(); k++){
+    Value *other = shfl_sync(totals[k], "up", i32(stride));
+    prefix[k] = select(icmp_uge(lane, i32(1)), other, identity);
+  }
+
+  // totals of every (warp, repetition), visible to all threads
+  std::map<key_t, std::vector<Value*>> warp_totals;
+  if(num_warps > 1){
+    analysis::shared_layout* tmp = layouts_->get(layouts_->tmp(x))->to_shared();
+    Value *base = bit_cast(shared_ptr_.at(tmp), ptr_ty(ty, shmem_->getType()->getPointerAddressSpace()));
+    auto shape = tmp->get_shape();
+    auto order = tmp->get_order();
+    // last lane of each warp writes; threads beyond `mts` hold replicated data
+    BasicBlock *current = builder_->GetInsertBlock();
+    BasicBlock *write_bb = BasicBlock::Create(*ctx_, "scan_write", current->getParent());
+    BasicBlock *done = BasicBlock::Create(*ctx_, "scan_write_done", current->getParent());
+    cond_br(and_(icmp_eq(lane, i32(num_lanes - 1)), icmp_ult(thread, i32(mts))), write_bb, done);
+    builder_->SetInsertPoint(write_bb);
+    for(size_t k = 0; k < keys.size(); k++){
+      indices_t write_idx = keys[k].first;
+      write_idx[axis] = add(warp, i32(keys[k].second * num_warps));
+      store(totals[k], gep(base, shared_off(shape, order, write_idx)));
+    }
+    br(done);
+    builder_->SetInsertPoint(done);
+    add_barrier();
+    for(size_t k = 0; k < keys.size(); k++){
+      indices_t read_idx = keys[k].first;
+      for(int w = 0; w < num_warps; w++){
+        read_idx[axis] = i32(keys[k].second * num_warps + w);
+        warp_totals[keys[k]].push_back(load(gep(base, shared_off(shape, order, read_idx))));
+      }
+    }
+  }
+  else if(num_reps > 1){
+    // the last lane along `axis` holds the total of the warp
+    Value *hw_lane = urem(tgt_->get_local_id(mod_, *builder_, 0), i32(32));
+    Value *last = add(hw_lane, mul(sub(i32(num_lanes - 1), lane), i32(stride)));
+    for(size_t k = 0; k < keys.size(); k++)
+      warp_totals[keys[k]].push_back(shfl_sync(totals[k], "idx", last));
+  }
+
+  // combine: previous repetitions, previous warps, previous lanes, then
+  // previous elements of the thread
+  std::map<indices_t, Value*> carry;
+  for(size_t k = 0; k < keys.size(); k++){
+    const indices_t& pidx = keys[k].first;
+    Value *acc = carry.count(pidx) ? carry.at(pidx) : identity;
+    Value *rep_total = acc;
+    if(num_warps > 1 || num_reps > 1){
+      const auto& wt = warp_totals.at(keys[k]);
+      for(int w = 0; w < (int)wt.size(); w++){
+        if(num_warps > 1)
+          acc = select(icmp_ult(i32(w), warp), do_acc(acc, wt[w]), acc);
+        rep_total = do_acc(rep_total, wt[w]);
+      }
+    }
+    carry[pidx] = rep_total;
+    acc = do_acc(acc, prefix[k]);
+    const auto& line = lines.at(pidx);
+    const auto& loc = local.at(keys[k]);
+    for(size_t j = 0; j < loc.size(); j++){
+      Value *ret = x->is_exclusive() ? (j == 0 ? acc : do_acc(acc, loc[j - 1]))
+                                     : do_acc(acc, loc[j]);
+      vals_[x][line[keys[k].second*nts + j]] = is_bf16 ? fp32_to_bf16(ret) : ret;
+    }
+  }
 }
 
 /**
@@ -1904,10 +2863,23 @@ void generator::visit_recoalesce_inst(ir::recoalesce_inst* rc) {
   analysis::scanline_layout* out_layout = layouts_->get(rc)->to_scanline();
   // Orders
   auto ord = layouts_->get(rc)->to_scanline()->get_order();
+  analysis::shared_layout* tmp = layouts_->get(layouts_->tmp(rc))->to_shared();
   Value *base;
-  base = gep(shmem_, i32(alloc_->offset(layouts_->get(layouts_->tmp(rc)))));
+  base = gep(shmem_, i32(alloc_->offset(tmp)));
   base = bit_cast(base, ptr_ty(ty, 3));
   Value *ld = i32(shape[ord[0]]);
+  // rows of the temporary are swizzled so that the column-wise
+  // accesses of the mma layout do not conflict
+  int vec = swizzle_->get_vec(tmp);
+  int per_phase = swizzle_->get_per_phase(tmp);
+  int max_phase = swizzle_->get_max_phase(tmp);
+  auto offset = [&](Value *col, Value *row) {
+    if(max_phase > 1){
+      Value *phase = urem(udiv(row, i32(per_phase)), i32(max_phase));
+      col = add(mul(xor_(udiv(col, i32(vec)), phase), i32(vec)), urem(col, i32(vec)));
+    }
+    return add(col, mul(row, ld));
+  };
   auto in_ord0 = axes_.at(a_axes_->get(op, ord[0])).values;
   auto in_ord1 = axes_.at(a_axes_->get(op, ord[1])).values;
   auto out_ord0 = axes_.at(a_axes_->get(rc, ord[0])).values;
@@ -1917,6 +2889,11 @@ void generator::visit_recoalesce_inst(ir::recoalesce_inst* rc) {
   int out_spt0 = out_layout->mts(ord[0])*out_layout->nts(ord[0]);
   int out_spt1 = out_layout->mts(ord[1])*out_layout->nts(ord[1]);
   int max_spt1 = std::max(in_spt1, out_spt1);
+  // the contiguous elements of each thread are read at once, as long as
+  // swizzling keeps them contiguous
+  int out_vec = out_layout->nts(ord[0]);
+  if(max_phase > 1 && vec % out_vec != 0)
+    out_vec = 1;
   indices_t idx(2);
   int num_packs = shape[ord[1]]/max_spt1;
   for(size_t j = 0; j < num_packs; j++){
@@ -1925,18 +2902,19 @@ void generator::visit_recoalesce_inst(ir::recoalesce_inst* rc) {
     for(size_t i = 0; i < in_ord0.size(); i++){
       idx[ord[0]] = in_ord0[i];
       idx[ord[1]] = in_ord1[j*in_ord1.size()/num_packs + k];
-      Value *off = add(idx[ord[0]], mul(in_ord1[k], ld));
-      Value *ptr = gep(base, off);
+      Value *ptr = gep(base, offset(idx[ord[0]], in_ord1[k]));
       store(vals_[op][idx], ptr);
     }
     add_barrier();
     for(size_t k = 0; k < out_ord1.size()/num_packs; k++)
-    for(size_t i = 0; i < out_ord0.size(); i++){
-      idx[ord[0]] = out_ord0[i];
+    for(size_t i = 0; i < out_ord0.size(); i += out_vec){
       idx[ord[1]] = out_ord1[j*out_ord1.size()/num_packs + k];
-      Value *off = add(idx[ord[0]], mul(out_ord1[k], ld));
-      Value *ptr  = gep(base, off);
-      vals_[rc][idx] = load(ptr);
+      Value *ptr  = gep(base, offset(out_ord0[i], out_ord1[k]));
+      Value *vals = load(bit_cast(ptr, ptr_ty(vec_ty(ty, out_vec), 3)));
+      for(int ii = 0; ii < out_vec; ii++){
+        idx[ord[0]] = out_ord0[i + ii];
+        vals_[rc][idx] = extract_elt(vals, ii);
+      }
     }
   }
 }
@@ -1950,7 +2928,7 @@ void generator::visit_masked_load_async_inst(ir::masked_load_async_inst* x){
   auto in_order = in_layout->get_order();
   // tiles
   if(out_order == in_order)
-    in_vec = in_layout->nts(in_order[0]);
+    in_vec = vector_width(x, arg, in_order[0], in_layout->nts(in_order[0]));
   int out_vec = swizzle_->get_vec(out_layout);
   int min_vec = std::min<int>(out_vec, in_vec);
   int s = std::max<int>(out_vec / in_vec, 1);
@@ -1994,6 +2972,14 @@ void generator::visit_masked_load_async_inst(ir::masked_load_async_inst* x){
     shared.push_back({tmp[key], off});
   }
   size_t dtsize = x->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
+  // cache hints: cp.async only caches in L1 (.ca) or, for 16-byte copies,
+  // in L2 only (.cg)
+  std::string mod = (in_vec*dtsize == 16) ? ".cg" : ".ca";
+  if(x->get_cache_modifier() == ir::io_inst::CA)
+    mod = ".ca";
+  Value *policy = cache_policy(x);
+  if(policy)
+    mod += ".L2::cache_hint";
   for(size_t i = 0; i < idxs_.at(arg).size(); i += in_vec){
     auto idx = idxs_[arg][i];
     // input ptr info
@@ -2009,16 +2995,25 @@ void generator::visit_masked_load_async_inst(ir::masked_load_async_inst* x){
     Value* out_base = shared[i].first;
     int out_off = shared[i].second*dtsize;
     // asm
-    std::string mod = (in_vec*dtsize == 16) ? ".cg" : ".ca";
 //    Value* false_value = vals_[x->get_false_value_operand()][idx];
 //    bool is_zero_false_value = false;
 //    if(Constant* cst = dyn_cast<Constant>(false_value))
 //      is_zero_false_value = cst->isZeroValue();
     Value* src_size = builder_->CreateSelect(vals_[x->get_mask_operand()][idx], i32(in_vec*dtsize), i32(0));
-    std::string asm_str = "cp.async" + mod + ".shared.global [$0 + " + std::to_string(out_off) + "], [$1 + " + std::to_string(in_off) + "], " + std::to_string(in_vec*dtsize) + ", $2;";
-    FunctionType *ty = FunctionType::get(void_ty, {out_base->getType(), ptr->getType(), builder_->getInt32Ty()}, false);
-    InlineAsm *iasm = InlineAsm::get(ty, asm_str, "r,l,r", true);
-    call(iasm, {out_base, ptr, src_size});
+    std::string asm_str = "cp.async" + mod + ".shared.global [$0 + " + std::to_string(out_off) + "], [$1 + " + std::to_string(in_off) + "], " + std::to_string(in_vec*dtsize) + ", $2";
+    std::vector<Type*> arg_tys = {out_base->getType(), ptr->getType(), builder_->getInt32Ty()};
+    std::vector<Value*> args = {out_base, ptr, src_size};
+    std::string constraints = "r,l,r";
+    if(policy){
+      asm_str += ", $3";
+      arg_tys.push_back(policy->getType());
+      args.push_back(policy);
+      constraints += ",l";
+    }
+    asm_str += ";";
+    FunctionType *ty = FunctionType::get(void_ty, arg_tys, false);
+    InlineAsm *iasm = InlineAsm::get(ty, asm_str, constraints, true);
+    call(iasm, args);
   }
 
   std::string asm_str = "cp.async.commit_group;";
@@ -2094,8 +3089,49 @@ void generator::visit_copy_to_shared_inst(ir::copy_to_shared_inst* cts) {
   };
 }
 
-void generator::visit_copy_from_shared_inst(ir::copy_from_shared_inst*) {
-  throw std::runtime_error("TODO");
+void generator::visit_copy_from_shared_inst(ir::copy_from_shared_inst* cfs) {
+  ir::value *arg = cfs->get_operand(0);
+  analysis::shared_layout* in_layout = layouts_->get(arg)->to_shared();
+  analysis::scanline_layout* out_layout = layouts_->get(cfs)->to_scanline();
+  if(!in_layout || !out_layout)
+    throw std::runtime_error("unsupported copy from shared memory");
+  auto in_order = in_layout->get_order();
+  auto out_order = out_layout->get_order();
+  auto shapes = in_layout->get_shape();
+  size_t rank = shapes.size();
+  Type *ty = cvt(in_layout->get_type());
+  int dtsize = in_layout->get_type()->get_primitive_size_in_bits() / 8;
+  int per_phase = swizzle_->get_per_phase(in_layout);
+  int max_phase = swizzle_->get_max_phase(in_layout);
+  // elements contiguous both in registers and in shared memory are read
+  // together, without crossing a swizzled chunk or 16 bytes
+  int vec = 1;
+  if(in_order[0] == out_order[0])
+    vec = std::min<int>(out_layout->nts(out_order[0]), 16 / dtsize);
+  if(max_phase > 1)
+    vec = std::min<int>(vec, swizzle_->get_vec(in_layout));
+  int swz_vec = swizzle_->get_vec(in_layout);
+  Value *base = bit_cast(shmems_.at(arg), ty->getPointerTo(3));
+  Type *vec_ptr_ty = vec_ty(ty, vec)->getPointerTo(3);
+  const auto& idxs = idxs_.at(cfs);
+  for(size_t i = 0; i < idxs.size(); i += vec){
+    const indices_t& idx = idxs[i];
+    Value *off_0 = idx[in_order[0]];
+    if(rank >= 2 && max_phase > 1){
+      Value *phase = urem(udiv(idx[in_order[1]], i32(per_phase)), i32(max_phase));
+      off_0 = add(mul(xor_(udiv(off_0, i32(swz_vec)), phase), i32(swz_vec)), urem(off_0, i32(swz_vec)));
+    }
+    Value *off = off_0;
+    int stride = shapes[in_order[0]];
+    for(size_t k = 1; k < rank; k++){
+      off = add(off, mul(idx[in_order[k]], i32(stride)));
+      stride *= shapes[in_order[k]];
+    }
+    Value *ptr = bit_cast(gep(base, off), vec_ptr_ty);
+    Value *val = load(ptr);
+    for(int k = 0; k < vec; k++)
+      vals_[cfs][idxs[i + k]] = extract_elt(val, k);
+  }
 }
 
 Instruction* generator::add_barrier() {
@@ -2294,7 +3330,7 @@ void generator::visit_layout_mma(analysis::mma_layout* layout) {
   Value *lane = urem(thread, _32);
   Value *warp = udiv(thread, _32);
   /* lane offset */
-  if(cc < 80){
+  if(cc < 75){
     auto ord_a = layout_a->get_order();
     auto ord_b = layout_b->get_order();
     bool is_a_row = ord_a[0] != 0;
@@ -2351,8 +3387,9 @@ void generator::visit_layout_mma(analysis::mma_layout* layout) {
       offset_b_k_[layout] = i32(0);
     }
     /* axes */
+    // column indices come in pairs of contiguous elements
     axes_[layout->get_axis(0)] = distributed_axis{1, idx_m, warp_0};
-    axes_[layout->get_axis(1)] = distributed_axis{1, idx_n, warp_1};
+    axes_[layout->get_axis(1)] = distributed_axis{2, idx_n, warp_1};
   }
   else{
     /* warp offset */
@@ -2382,8 +3419,9 @@ void generator::visit_layout_mma(analysis::mma_layout* layout) {
       idx_n.push_back(add(off_c_n, i32(n + 1)));
     }
     /* axes */
+    // column indices come in pairs of contiguous elements
     axes_[layout->get_axis(0)] = distributed_axis{1, idx_m, warp_0};
-    axes_[layout->get_axis(1)] = distributed_axis{1, idx_n, warp_1};
+    axes_[layout->get_axis(1)] = distributed_axis{2, idx_n, warp_1};
   }
 }
 
@@ -13,7 +13,8 @@ namespace codegen{
 namespace transform{
 
 coalesce::coalesce(analysis::align* align, analysis::layouts *layouts)
-  : align_(align), layout_(layouts) { }
+  : align_(align), layout_(layouts), num_staged_stores_(0),
+    num_conversions_(0), num_avoided_conversions_(0) { }
 
 // Find all values that are used as pointer operands in LD/ST
 void coalesce::extract_io_use(ir::value *v, std::set<ir::io_inst*>& result) {
@@ -61,8 +62,95 @@ ir::value* coalesce::rematerialize(ir::value *x, ir::builder &builder,
   return cloned;
 }
 
+// A global memory instruction is counted as expensive as four shared
+// memory accesses, and a barrier as two global memory instructions
+static const double global_cost = 4.;
+static const double shared_cost = 2.;
+static const double barrier_cost = 8.;
+
+// Threads own pairs of elements of mma fragments that are contiguous
+// along the second axis, so that fragments are stored to global memory
+// at most two elements at a time. Either way, the threads of a quad only
+// write 8 contiguous elements per row (or column) and 32-byte sectors are
+// only filled by 32-bit elements. Going through shared memory instead
+// (recoalesce) lets the store use the scanline layout of the pointer,
+// vectorized up to 128 bits, and costs a write and a read of shared
+// memory per element and two barriers per thread.
+bool coalesce::is_staging_profitable(ir::store_inst *x) {
+  ir::value *ptr = x->get_pointer_operand();
+  if(ptr->get_type()->get_tile_rank() != 2)
+    return false;
+  analysis::mma_layout *mma = layout_->get(x->get_value_operand())->to_mma();
+  auto contiguous = align_->contiguous(ptr);
+  int axis = std::distance(contiguous.begin(), std::max_element(contiguous.begin(), contiguous.end()));
+  int nbits = ptr->get_type()->get_scalar_ty()->get_pointer_element_ty()->get_primitive_size_in_bits();
+  int vec = std::max<int>(std::min<int>(align_->get(ptr, axis), 128 / nbits), 1);
+  int direct_vec = std::min(vec, axis == 1 ? 2 : 1);
+  double sector_use = std::min(1., nbits / 32.);
+  const auto& shape = ptr->get_type()->get_block_shapes();
+  double num_per_thread = double(shape[0]) * shape[1] / (mma->wpt(0) * mma->wpt(1) * 32);
+  double direct = global_cost / direct_vec / sector_use;
+  double staged = global_cost / vec + shared_cost + 2 * barrier_cost / num_per_thread;
+  return staged < direct;
+}
+
+// Per-element cost of the memory instructions of `i` when its group is
+// laid out along `axis`. Accesses along their most contiguous axis are
+// vectorized. Others are either issued one element at a time, or, when it
+// is cheaper (`convert`), rematerialized in a layout of their own through
+// shared memory
+double coalesce::access_cost(ir::io_inst *i, int axis, bool *convert) {
+  ir::value *ptr = i->get_pointer_operand();
+  auto contiguous = align_->contiguous(ptr);
+  int pref = std::distance(contiguous.begin(), std::max_element(contiguous.begin(), contiguous.end()));
+  int nbits = ptr->get_type()->get_scalar_ty()->get_pointer_element_ty()->get_primitive_size_in_bits();
+  int vec = std::max<int>(std::min<int>(align_->get(ptr, pref), 128 / nbits), 1);
+  double coalesced = global_cost / vec;
+  *convert = false;
+  if(pref == axis)
+    return coalesced;
+  *convert = coalesced + shared_cost < global_cost;
+  return std::min(coalesced + shared_cost, global_cost);
+}
+
+// Staging only helps if the pointer (and mask) of the store leave the
+// mma layout, i.e., if they do not share axes with the stored value
+// through anything else than the store itself
+bool coalesce::is_staging_legal(ir::store_inst *x) {
+  auto has_axes_edge = [](ir::user *u, ir::value *op) {
+    if(dynamic_cast<ir::copy_to_shared_inst*>(u) ||
+       dynamic_cast<ir::copy_from_shared_inst*>(u) ||
+       dynamic_cast<ir::recoalesce_inst*>(u))
+      return false;
+    if(auto *dot = dynamic_cast<ir::dot_inst*>(u))
+      return op == dot->get_operand(2);
+    return true;
+  };
+  std::vector<ir::value*> worklist = {x->get_pointer_operand()};
+  if(auto *mx = dynamic_cast<ir::masked_store_inst*>(x))
+    worklist.push_back(mx->get_mask_operand());
+  std::set<ir::value*> seen;
+  while(!worklist.empty()){
+    ir::value *v = worklist.back();
+    worklist.pop_back();
+    if(!v->get_type()->is_block_ty() || !seen.insert(v).second)
+      continue;
+    if(v == x->get_value_operand())
+      return false;
+    if(auto *u = dynamic_cast<ir::user*>(v))
+    for(ir::value *op: u->ops())
+      if(has_axes_edge(u, op))
+        worklist.push_back(op);
+    for(ir::user *u: v->get_users())
+      if(u != x && has_axes_edge(u, v))
+        worklist.push_back(u);
+  }
+  return true;
+}
+
 void coalesce::run(ir::module &mod) {
   size_t num_groups = layout_->num_layouts();
+  num_staged_stores_ = 0;
 
 
   for(size_t id = 0; id < num_groups; id++) {
@@ -96,9 +184,26 @@ void coalesce::run(ir::module &mod) {
         if(seen.find(u) == seen.end())
           worklist.push_back(u);
     }
+    // stores of values that are still mma fragments
+    std::vector<ir::store_inst*> stores;
+    for(ir::value *v: values)
+    for(ir::user *u: v->get_users())
+      if(auto *st = dynamic_cast<ir::store_inst*>(u))
+      if(st->get_value_operand() == v && is_staging_profitable(st) && is_staging_legal(st))
+        stores.push_back(st);
+    for(ir::store_inst *st: stores){
+      builder.set_insert_point(st);
+      ir::value *val = st->get_value_operand();
+      ir::recoalesce_inst* rc = ir::recoalesce_inst::create(val);
+      builder.insert(rc);
+      st->replace_uses_of_with(val, rc);
+      num_staged_stores_++;
+    }
   }
 
   // find values to rematerialize
+  num_conversions_ = 0;
+  num_avoided_conversions_ = 0;
   std::vector<ir::io_inst*> remat;
   for(size_t id = 0; id < num_groups; id++) {
     const auto& values = layout_->values_of(id);
@@ -113,14 +218,45 @@ void coalesce::run(ir::module &mod) {
         extract_ld(i, axes);
       }
     }
-    // update list of values to rematerialize
     if(axes.empty())
       continue;
-    for(auto it = ++axes.rbegin(); it != axes.rend(); it++){
-      if(it->second.size() == 1)
-        continue;
-      remat.insert(remat.begin(), it->second.begin(), it->second.end());
+    // leading axis of the group that minimizes the cost of its accesses.
+    // As in `data_layout`, the current leading axis is kept unless another
+    // one is strictly cheaper
+    auto group_cost = [&](int axis) {
+      double cost = 0;
+      bool convert;
+      for(auto& y: axes)
+      for(ir::io_inst *i: y.second)
+        cost += access_cost(i, axis, &convert);
+      return cost;
+    };
+    int best = layout_->get(id)->get_order()[0];
+    double best_cost = group_cost(best);
+    for(auto& x: axes){
+      double cost = group_cost(x.first);
+      if(cost < best_cost){
+        best = x.first;
+        best_cost = cost;
+      }
+    }
+    std::set<ir::io_inst*> converted;
+    for(auto& x: axes)
+    for(ir::io_inst *i: x.second){
+      bool convert;
+      access_cost(i, best, &convert);
+      if(convert)
+        converted.insert(i);
     }
+    remat.insert(remat.end(), converted.begin(), converted.end());
+    num_conversions_ += converted.size();
+    // net number of conversions saved with respect to keeping the last
+    // axis and converting the other accesses, as done before
+    int old_conversions = 0;
+    for(auto it = ++axes.rbegin(); it != axes.rend(); it++)
+      if(it->second.size() > 1)
+        old_conversions += it->second.size();
+    num_avoided_conversions_ += old_conversions - (int)converted.size();
   }
   // rematerialize values
   for(ir::io_inst *r: remat) {
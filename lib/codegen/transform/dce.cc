@@ -1,6 +1,8 @@
+#include <algorithm>
 #include "triton/codegen/transform/dce.h"
 #include "triton/ir/function.h"
 #include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
 #include "triton/ir/module.h"
 #include "triton/ir/utils.h"
 
@@ -9,65 +11,146 @@ namespace codegen{
 namespace transform{
 
 
-void dce::run(ir::module &mod) {
+void dce::run(ir::function *fn, ir::module &mod) {
   std::list<ir::instruction*> work_list;
   std::set<ir::instruction*> marked;
+  std::set<ir::basic_block*> live_blocks;
+  auto mark = [&](ir::instruction* i) {
+    if(marked.insert(i).second)
+      work_list.push_back(i);
+  };
+
+  // post-dominance frontier
+  std::map<ir::basic_block*, ir::basic_block*> ipdom = ir::cfg::immediate_post_dominators(fn);
+  std::map<ir::basic_block*, std::set<ir::basic_block*>> pdf;
+  for(ir::basic_block *block: fn->blocks()){
+    if(block->get_successors().size() < 2 || ipdom.find(block) == ipdom.end())
+      continue;
+    for(ir::basic_block *runner: block->get_successors())
+      while(runner && runner != ipdom.at(block) && ipdom.find(runner) != ipdom.end()){
+        pdf[runner].insert(block);
+        runner = ipdom.at(runner);
+      }
+  }
 
   // initialize work-list
-  for(ir::function *fn: mod.get_function_list()){
-    std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
-    // iterate through blocks
-    for(ir::basic_block *block: rpo)
-    for(ir::instruction *i: block->get_inst_list()){
-      switch(i->get_id()){
-        case ir::INST_RETURN:
-        case ir::INST_UNCOND_BRANCH:
-        case ir::INST_COND_BRANCH:
-        case ir::INST_UNMASKED_STORE:
-        case ir::INST_MASKED_STORE:
-        case ir::INST_ATOMIC_CAS:
-        case ir::INST_ATOMIC_RMW:
-        case ir::INST_ATOMIC_EXCH:
-        case ir::INST_BARRIER: {
-          work_list.push_back(i);
-          marked.insert(i);
-          break;
-        }
-        default:
-          break;
+  std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
+  for(ir::basic_block *block: rpo)
+  for(ir::instruction *i: block->get_inst_list()){
+    switch(i->get_id()){
+      case ir::INST_RETURN:
+      case ir::INST_UNMASKED_STORE:
+      case ir::INST_MASKED_STORE:
+      case ir::INST_ATOMIC_CAS:
+      case ir::INST_ATOMIC_RMW:
+      case ir::INST_ATOMIC_EXCH:
+      case ir::INST_BARRIER: {
+        mark(i);
+        break;
+      }
+      case ir::INST_COND_BRANCH: {
+        // no post-dominator to jump to instead
+        auto it = ipdom.find(block);
+        if(it == ipdom.end() || it->second == nullptr)
+          mark(i);
+        break;
       }
+      default:
+        break;
     }
   }
 
-  // mark -- ignore branches
+  // mark
+  auto mark_block = [&](ir::basic_block* block) {
+    if(!live_blocks.insert(block).second)
+      return;
+    for(ir::basic_block* dep: pdf[block])
+      mark(dep->get_inst_list().back());
+  };
   while(!work_list.empty()){
     ir::instruction* current = work_list.back();
     work_list.pop_back();
     // mark instruction operands
     for(ir::value* op: current->ops()) {
-      if(auto *i = dynamic_cast<ir::instruction*>(op)){
-        if(marked.insert(i).second)
-          work_list.push_back(i);
-      }
+      if(auto *i = dynamic_cast<ir::instruction*>(op))
+        mark(i);
     }
-    // TODO: mark last intstruction of current's reverse-dominance frontier
+    // mark branches `current` is control-dependent on
+    mark_block(current->get_parent());
+    if(auto *phi = dynamic_cast<ir::phi_node*>(current))
+      for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+        mark_block(phi->get_incoming_block(n));
+  }
+
+  // sweep -- dead branches jump to their post-dominator
+  ir::builder &builder = mod.get_builder();
+  for(ir::basic_block *block: rpo){
+    if(block->empty())
+      continue;
+    ir::instruction* term = block->get_inst_list().back();
+    if(term->get_id() != ir::INST_COND_BRANCH || marked.find(term) != marked.end())
+      continue;
+    ir::basic_block* dest = ipdom.at(block);
+    std::vector<ir::basic_block*> succs = block->get_successors();
+    for(ir::basic_block* succ: succs)
+      if(succ != dest)
+        succ->remove_predecessor(block);
+    if(std::find(succs.begin(), succs.end(), dest) == succs.end())
+      dest->add_predecessor(block);
+    term->erase_from_parent();
+    builder.set_insert_point(block);
+    ir::instruction* br = builder.insert(ir::branch_inst::create(dest));
+    marked.insert(br);
+    num_dead_branches_++;
   }
 
   // sweep -- delete non-branch unmarked instructions
   std::vector<ir::instruction*> to_delete;
-  for(ir::function *fn: mod.get_function_list()){
-    std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
-    // iterate through blocks
-    for(ir::basic_block *block: rpo)
-    for(ir::instruction *i: block->get_inst_list()){
-      if(marked.find(i) == marked.end())
-        to_delete.push_back(i);
-    }
+  for(ir::basic_block *block: rpo)
+  for(ir::instruction *i: block->get_inst_list()){
+    if(i->get_id() == ir::INST_UNCOND_BRANCH)
+      continue;
+    if(marked.find(i) == marked.end())
+      to_delete.push_back(i);
   }
-
-  // delete
-  for(ir::instruction* i: to_delete)
+  for(ir::instruction* i: to_delete){
+    if(dynamic_cast<ir::phi_node*>(i))
+      num_dead_phis_++;
+    else
+      num_dead_insts_++;
     i->erase_from_parent();
+  }
+
+  // sweep -- delete unreachable blocks
+  std::set<ir::basic_block*> is_reachable;
+  std::vector<ir::basic_block*> stack = {fn->blocks().front()};
+  is_reachable.insert(stack.back());
+  while(!stack.empty()){
+    ir::basic_block* current = stack.back();
+    stack.pop_back();
+    for(ir::basic_block* succ: current->get_successors())
+      if(is_reachable.insert(succ).second)
+        stack.push_back(succ);
+  }
+  std::vector<ir::basic_block*> blocks = fn->blocks();
+  for(ir::basic_block *block: blocks){
+    if(is_reachable.find(block) != is_reachable.end())
+      continue;
+    std::vector<ir::instruction*> insts(block->get_inst_list().begin(), block->get_inst_list().end());
+    for(ir::instruction* i: insts)
+      i->erase_from_parent();
+    std::vector<ir::basic_block*> succs = block->get_successors();
+    for(ir::basic_block* succ: succs)
+      succ->remove_predecessor(block);
+    fn->erase_block(block);
+    num_dead_blocks_++;
+  }
+}
+
+void dce::run(ir::module &mod) {
+  for(ir::function *fn: mod.get_function_list())
+    if(!fn->blocks().empty())
+      run(fn, mod);
 }
 
 }
@@ -48,9 +48,7 @@ inline bool membar::intersect_with(analysis::shared_layout* a_layout, analysis::
   int a_end = a_start + a_layout->get_size();
   int b_start = alloc_->offset(b_layout);
   int b_end = b_start + b_layout->get_size();
-  if(a_start < b_end || b_start < a_end)
-    return true;
-  return false;
+  return a_start < b_end && b_start < a_end;
 }
 
 membar::val_set_t membar::intersect_with(const val_set_t& as, const val_set_t& bs) {
@@ -98,7 +96,7 @@ void membar::transfer(ir::basic_block *block,
                       val_set_t& sync_write,
                       val_set_t& sync_read,
                       std::set<ir::value*>& safe_war,
-                      bool& inserted, ir::builder& builder) {
+                      bool& inserted, ir::builder& builder, bool dry_run) {
   std::vector<ir::async_wait_inst*> async_waits;
   ir::basic_block::inst_list_t instructions = block->get_inst_list();
   for(ir::instruction *i: instructions){
@@ -126,6 +124,10 @@ void membar::transfer(ir::basic_block *block,
       std::transform(read.begin(), read.end(), groups.begin(), [&](ir::value* v){ return group_of(v, async_write);});
       int N = *std::max_element(groups.begin(), groups.end());
       if(N < async_write.size()){
+        if(dry_run){
+          inserted = true;
+          return;
+        }
         builder.set_insert_point(i);
         async_wait = (ir::async_wait_inst*)builder.create_async_wait(async_write.size() - 1 - N);
         barrier = (ir::barrier_inst*)builder.create_barrier();
@@ -138,6 +140,10 @@ void membar::transfer(ir::basic_block *block,
     // WAR barrier is not required when data is double-buffered
     if(!intersect_with(read, sync_write).empty() || 
        (!intersect_with({i}, sync_read).empty() && !is_safe_war)) {
+      if(dry_run){
+        inserted = true;
+        return;
+      }
       builder.set_insert_point(i);
       barrier = (ir::barrier_inst*)builder.create_barrier();
       inserted = true;
@@ -191,6 +197,88 @@ void membar::transfer(ir::basic_block *block,
   }
 }
 
+// Propagates pending shared memory accesses through the CFG until a fixed
+// point is reached. Unless `dry_run` is set, barriers (and async waits) are
+// inserted before every hazard found on the way, and the propagation is
+// restarted. Returns whether any hazard was found
+bool membar::propagate(ir::function *fn, std::set<ir::value*>& safe_war, ir::builder &builder, bool dry_run) {
+  std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
+  std::map<ir::basic_block*, val_vec_t> async_writes;
+  std::map<ir::basic_block*, val_set_t> sync_writes;
+  std::map<ir::basic_block*, val_set_t> sync_reads;
+  bool found = false;
+  bool changed;
+  do{
+    bool inserted = false;
+    changed = false;
+    // find barrier location
+    for(ir::basic_block *block: rpo){
+      // join inputs
+      val_vec_t async_write;
+      val_set_t sync_write;
+      val_set_t sync_read;
+      val_set_t tmp;
+      for(ir::basic_block* pred: block->get_predecessors()){
+        for(ir::value* v: async_writes[pred])
+          if(tmp.insert(v).second)
+            async_write.push_back(v);
+        sync_write.insert(sync_writes[pred].begin(), sync_writes[pred].end());
+        sync_read.insert(sync_reads[pred].begin(), sync_reads[pred].end());
+      }
+      transfer(block, async_write, sync_write, sync_read, safe_war, inserted, builder, dry_run);
+      if(dry_run && inserted)
+        return true;
+      changed |= async_writes[block] != async_write ||
+                 sync_writes[block] != sync_write ||
+                 sync_reads[block] != sync_read;
+      async_writes[block] = async_write;
+      sync_writes[block] = sync_write;
+      sync_reads[block] = sync_read;
+    }
+    found |= inserted;
+    changed |= inserted;
+  }while(changed);
+  return found;
+}
+
+// Barriers are inserted greedily, right before the first access of each
+// hazard, and the states joined at loop headers only become exact after a
+// few rounds: some barriers end up covered by others. A barrier is removed
+// when no hazard remains without it. Barriers completing an async wait are
+// kept, as they make the copies visible to all threads, and so are the
+// barriers written by the user
+void membar::minimize(ir::function *fn, std::set<ir::value*>& safe_war, const std::set<ir::value*>& keep,
+                      ir::builder &builder) {
+  std::vector<ir::barrier_inst*> barriers;
+  for(ir::basic_block *block: fn->blocks()){
+    ir::instruction *prev = nullptr;
+    for(ir::instruction *i: block->get_inst_list()){
+      auto *barrier = dynamic_cast<ir::barrier_inst*>(i);
+      if(barrier && !keep.count(barrier) && !dynamic_cast<ir::async_wait_inst*>(prev))
+        barriers.push_back(barrier);
+      prev = i;
+    }
+  }
+  for(ir::barrier_inst *barrier: barriers){
+    ir::basic_block *block = barrier->get_parent();
+    auto it = std::find(block->begin(), block->end(), (ir::instruction*)barrier);
+    ir::instruction *next = *std::next(it);
+    block->erase(barrier);
+    if(propagate(fn, safe_war, builder, true)){
+      builder.set_insert_point(next);
+      builder.insert(barrier);
+    }
+  }
+}
+
+unsigned membar::count_barriers(ir::module &mod) {
+  unsigned ret = 0;
+  ir::for_each_instruction(mod, [&](ir::instruction *i) {
+    ret += dynamic_cast<ir::barrier_inst*>(i) != nullptr;
+  });
+  return ret;
+}
+
 void membar::run(ir::module &mod) {
   ir::builder &builder = mod.get_builder();
   // extract phi-node associates with double-buffered
@@ -207,36 +295,17 @@ void membar::run(ir::module &mod) {
       }
   }
 
-  for(ir::function *fn: mod.get_function_list()){
-    std::vector<ir::basic_block*> rpo = ir::cfg::reverse_post_order(fn);
-    std::map<ir::basic_block*, val_vec_t> async_writes;
-    std::map<ir::basic_block*, val_set_t> sync_writes;
-    std::map<ir::basic_block*, val_set_t> sync_reads;
-    std::list<ir::value *> pipelined;
-    bool inserted;
-    do{
-      inserted = false;
-      // find barrier location
-      for(ir::basic_block *block: rpo){
-        // join inputs
-        val_vec_t async_write;
-        val_set_t sync_write;
-        val_set_t sync_read;
-        val_set_t tmp;
-        for(ir::basic_block* pred: block->get_predecessors()){
-          for(ir::value* v: async_writes[pred])
-            if(tmp.insert(v).second)
-              async_write.push_back(v);
-          sync_write.insert(sync_writes[pred].begin(), sync_writes[pred].end());
-          sync_read.insert(sync_reads[pred].begin(), sync_reads[pred].end());
-        }
-        transfer(block, async_write, sync_write, sync_read, safe_war, inserted, builder);
-        async_writes[block] = async_write;
-        sync_writes[block] = sync_write;
-        sync_reads[block] = sync_read;
-      }
-    }while(inserted);
-  }
+  std::set<ir::value*> user_barriers;
+  ir::for_each_instruction(mod, [&](ir::instruction *i) {
+    if(dynamic_cast<ir::barrier_inst*>(i))
+      user_barriers.insert(i);
+  });
+  for(ir::function *fn: mod.get_function_list())
+    propagate(fn, safe_war, builder, false);
+  num_inserted_barriers_ = count_barriers(mod) - user_barriers.size();
+  for(ir::function *fn: mod.get_function_list())
+    minimize(fn, safe_war, user_barriers, builder);
+  num_barriers_ = count_barriers(mod) - user_barriers.size();
 }
 
 }
@@ -61,7 +61,7 @@ bool peephole::rewrite_dot(ir::instruction *value, ir::builder& builder){
   // dot(a, b, c) + d -> dot(a, b, c + d)
   // d + dot(a, b, c) -> dot(a, b, c + d)
   auto add = dynamic_cast<ir::binary_operator*>(value);
-  if(add && add->get_op() == ir::binary_op_t::FAdd) {
+  if(add && (add->get_op() == ir::binary_op_t::FAdd || add->get_op() == ir::binary_op_t::Add)) {
     ir::value *lhs = add->get_operand(0);
     ir::value *rhs = add->get_operand(1);
     ir::dot_inst *lhs_dot = dynamic_cast<ir::dot_inst*>(lhs);
@@ -72,15 +72,17 @@ bool peephole::rewrite_dot(ir::instruction *value, ir::builder& builder){
     ir::value *other = (dot == lhs) ? rhs : lhs;
     ir::value *acc = dot->get_operand(2);
     ir::splat_inst *splat = dynamic_cast<ir::splat_inst*>(acc);
-    ir::constant_fp *_0 = nullptr;
-    if(splat)
-      _0 = dynamic_cast<ir::constant_fp*>(splat->get_operand(0));
-    if(!(_0 && _0->get_value() == 0.0))
+    ir::constant *_0 = splat ? dynamic_cast<ir::constant*>(splat->get_operand(0)) : nullptr;
+    ir::constant_fp *_0_fp = dynamic_cast<ir::constant_fp*>(_0);
+    ir::constant_int *_0_int = dynamic_cast<ir::constant_int*>(_0);
+    if(!(_0_fp && _0_fp->get_value() == 0.0) && !(_0_int && _0_int->get_value() == 0))
       return false;
     ir::value *a = dot->get_operand(0);
     ir::value *b = dot->get_operand(1);
     builder.set_insert_point(add);
-    ir::value * new_dot = builder.insert(ir::dot_inst::create_nn(a, b, other, dot->get_name()));
+    ir::dot_inst *new_dot = (ir::dot_inst*)ir::dot_inst::create_nn(a, b, other, dot->get_name());
+    new_dot->set_allow_tf32(dot->allow_tf32());
+    builder.insert(new_dot);
     add->replace_all_uses_with(new_dot);
     return true;
   }
@@ -116,7 +118,7 @@ bool peephole::rewrite_load_to_shared(ir::instruction *value, ir::builder& build
   int nts = layout->nts(layout->get_order()[0]);
   int dtsize = value->get_type()->get_scalar_ty()->get_primitive_size_in_bits() / 8;
   if(nts*dtsize >= 4){
-    ir::value* new_load = builder.create_masked_load_async(ptr, msk, val);
+    ir::value* new_load = builder.create_masked_load_async(ptr, msk, val, ld->get_cache_modifier(), ld->get_eviction_policy());
     copy_to_shared->replace_all_uses_with(new_load);
     return true;
   }
@@ -129,7 +131,7 @@ bool peephole::rewrite_load_to_shared(ir::instruction *value, ir::builder& build
 
 bool peephole::rewrite_unit_red(ir::instruction *value, ir::builder& builder){
   auto x = dynamic_cast<ir::reduce_inst*>(value);
-  if(!x)
+  if(!x || x->with_index())
     return false;
   ir::value *arg = x->get_operand(0);
   auto shapes = arg->get_type()->get_block_shapes();
@@ -206,7 +208,9 @@ bool peephole::rewrite_select_masked_load(ir::instruction *value, ir::builder& b
   builder.set_insert_point(select);
   ir::value* new_load = builder.create_masked_load(if_value->get_pointer_operand(),
                                                    if_value->get_mask_operand(),
-                                                   select->get_else_value_op());
+                                                   select->get_else_value_op(),
+                                                   if_value->get_cache_modifier(),
+                                                   if_value->get_eviction_policy());
   select->replace_all_uses_with(new_load);
   return true;
 }
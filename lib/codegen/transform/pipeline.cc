@@ -1,5 +1,7 @@
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <set>
 #include "triton/codegen/transform/pipeline.h"
 #include "triton/ir/module.h"
 #include "triton/ir/function.h"
@@ -100,27 +102,64 @@ void finalize_iv_vals(ir::builder& builder, std::map<ir::phi_node*, ir::value*>&
   }
 }
 
+/// whether `block` contains stores or atomics
+bool writes_memory(ir::basic_block* block) {
+  for(ir::instruction* i: block->get_inst_list())
+    if(dynamic_cast<ir::store_inst*>(i) || dynamic_cast<ir::atomic_inst*>(i))
+      return true;
+  return false;
+}
+
 void pipeline::run(ir::module &mod) {
-  // *Very* conservative heuristics for pre-fetching.
   // A load instruction can be pipelined if:
   //   - the pointer is a phi node that references a value
   //     in its basic block (i.e., pointer induction variable)
-  //   - the load has only  a single use in a dot instruction
-  // As more use cases become apparent, this pass will be improved
+  //   - the loop is this single basic block, guarded by a
+  //     conditional branch in its predecessor
+  //   - all its users are consumed in the same iteration
+  //     (i.e., non-phi instructions of its basic block)
+  //   - the loop does not write memory, unless all users are dots
   std::vector<std::pair<ir::load_inst*, ir::phi_node*>> to_pipeline;
+  std::set<ir::phi_node*> pipelined_ptrs;
   ir::for_each_instruction(mod, [&](ir::instruction *i){
-    if(auto* load = dynamic_cast<ir::load_inst*>(i)){
-      ir::phi_node* ptr = dynamic_cast<ir::phi_node*>(load->get_pointer_operand());
-      auto users = load->get_users();
-      if(ptr && ptr->get_incoming_block(1) == ptr->get_parent()
-         && users.size() == 1 && dynamic_cast<ir::dot_inst*>(*users.begin()))
-        to_pipeline.push_back({load, ptr});
-    }});
+    auto* load = dynamic_cast<ir::load_inst*>(i);
+    if(!load || dynamic_cast<ir::masked_load_async_inst*>(i) || !load->get_type()->is_block_ty())
+      return;
+    ir::phi_node* ptr = dynamic_cast<ir::phi_node*>(load->get_pointer_operand());
+    ir::basic_block* block = load->get_parent();
+    if(!ptr || ptr->get_parent() != block || ptr->get_incoming_block(1) != block)
+      return;
+    ir::basic_block* header = block->get_predecessors()[0];
+    if(!dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back()) ||
+       !dynamic_cast<ir::cond_branch_inst*>(header->get_inst_list().back()))
+      return;
+    auto users = load->get_users();
+    if(users.empty())
+      return;
+    bool has_non_dot_users = false;
+    for(ir::user* u: users){
+      auto* ui = dynamic_cast<ir::instruction*>(u);
+      if(!ui || ui->get_parent() != block || dynamic_cast<ir::phi_node*>(ui))
+        return;
+      has_non_dot_users |= !dynamic_cast<ir::dot_inst*>(ui);
+    }
+    // prefetching the next iteration hoists the load above the stores of
+    // the current one, which may write the memory it reads
+    if(has_non_dot_users && writes_memory(block))
+      return;
+    // the pointer phi is re-targeted by the multi-stage pipe
+    if(!pipelined_ptrs.insert(ptr).second)
+      return;
+    to_pipeline.push_back({load, ptr});
+  });
+  num_pipelined_loads_ = to_pipeline.size();
   // do the pipelining
   std::vector<ir::phi_node*> new_loads;
   ir::builder &builder = mod.get_builder();
   const int num_stages = num_stages_;
   std::vector<std::pair<ir::phi_node*, std::vector<ir::value*>>> preheader_loads; // Used to reorder loads
+  // loads with consumers other than dots, and these consumers
+  std::vector<std::pair<ir::phi_node*, std::set<ir::user*>>> to_stage;
   for(auto info: to_pipeline){
     ir::load_inst* load = info.first;
     ir::phi_node* ptr   = info.second;
@@ -128,9 +167,11 @@ void pipeline::run(ir::module &mod) {
     ir::basic_block* header = block->get_predecessors()[0];
     auto* block_br = dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back());
     auto* header_br = dynamic_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
-    assert(block_br);
-    assert(header_br);
     ir::type* ty = load->get_type();
+    std::set<ir::user*> non_dot_users;
+    for(ir::user* u: load->get_users())
+      if(!dynamic_cast<ir::dot_inst*>(u))
+        non_dot_users.insert(u);
     // multi-stage pipe
     if (has_copy_async_ && num_stages > 2) {
       ir::value* header_cond = header_br->get_cond();
@@ -164,7 +205,7 @@ void pipeline::run(ir::module &mod) {
         false_value = remat_false_value;
       } else
         false_value = builder.create_splat(ir::undef_value::get(ty->get_scalar_ty()), ty->get_block_shapes());
-      first_loads[0] = builder.create_masked_load(first_ptrs[0], first_masks[0], false_value);
+      first_loads[0] = builder.create_masked_load(first_ptrs[0], first_masks[0], false_value, load->get_cache_modifier(), load->get_eviction_policy());
 
       for (int stage = 1; stage < num_stages-1; ++stage) {
         // mask is the loop condition of the previous iteration
@@ -179,7 +220,7 @@ void pipeline::run(ir::module &mod) {
           first_masks[stage] = builder.create_and(first_masks[stage], remat_mask);
           false_value = remat_false_value;
         }
-        first_loads[stage] = builder.create_masked_load(first_ptrs[stage], first_masks[stage], false_value);
+        first_loads[stage] = builder.create_masked_load(first_ptrs[stage], first_masks[stage], false_value, load->get_cache_modifier(), load->get_eviction_policy());
       }
 
       // create new phis for induction variables
@@ -207,7 +248,7 @@ void pipeline::run(ir::module &mod) {
         next_mask = builder.create_and(next_mask, remat_mask);
         false_value = remat_false_value;
       }
-      ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value);
+      ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value, load->get_cache_modifier(), load->get_eviction_policy());
 
 
       // phi node
@@ -225,6 +266,8 @@ void pipeline::run(ir::module &mod) {
       new_load_phis.back()->add_incoming(next_load, block);
       load->replace_all_uses_with(new_load_phis.front());
       new_loads.push_back(new_load_phis.back());
+      if(!non_dot_users.empty())
+        to_stage.push_back({new_load_phis.front(), non_dot_users});
 
       // record first_loads to reorder them
       preheader_loads.push_back({new_load_phis.front(), first_loads});
@@ -242,7 +285,7 @@ void pipeline::run(ir::module &mod) {
       }
       else
         false_value = builder.create_splat(ir::undef_value::get(ty->get_scalar_ty()), ty->get_block_shapes());
-      ir::value* first_load = builder.create_masked_load(first_ptr, first_mask, false_value);
+      ir::value* first_load = builder.create_masked_load(first_ptr, first_mask, false_value, load->get_cache_modifier(), load->get_eviction_policy());
       // pre-fetch next iteration
       builder.set_insert_point(block->get_inst_list().back());
       ir::value* next_ptr = ptr->get_value_for_block(block);
@@ -253,7 +296,7 @@ void pipeline::run(ir::module &mod) {
         next_mask = builder.create_and(next_mask, remat_mask);
         false_value = remat_false_value;
       }
-      ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value);
+      ir::value* next_load = builder.create_masked_load(next_ptr, next_mask, false_value, load->get_cache_modifier(), load->get_eviction_policy());
       // phi node
       builder.set_insert_point(block->get_first_non_phi());
       ir::phi_node* new_load = builder.create_phi(ty, 2);
@@ -261,6 +304,8 @@ void pipeline::run(ir::module &mod) {
       new_load->add_incoming(next_load, block);
       load->replace_all_uses_with(new_load);
       new_loads.push_back(new_load);
+      if(has_copy_async_ && !non_dot_users.empty())
+        to_stage.push_back({new_load, non_dot_users});
     }
   }
 
@@ -279,6 +324,37 @@ void pipeline::run(ir::module &mod) {
     }
   }
 
+  // With cp.async, loads consumed outside of dots are also staged in
+  // shared memory (operands of dots are handled by the cts pass), and
+  // read back right before their first consumer. Otherwise they are
+  // simply prefetched in registers
+  for(auto& x: to_stage){
+    ir::phi_node* phi = x.first;
+    std::set<ir::user*>& users = x.second;
+    std::function<void(ir::phi_node*)> add_copies = [&](ir::phi_node* pn){
+      for(unsigned n = 0; n < pn->get_num_incoming(); n++){
+        ir::value* v = pn->get_incoming_value(n);
+        if(auto* inc_phi = dynamic_cast<ir::phi_node*>(v)){
+          add_copies(inc_phi);
+          continue;
+        }
+        builder.set_insert_point_after((ir::instruction*)v);
+        pn->set_incoming_value(n, builder.create_copy_to_shared(v));
+      }
+    };
+    add_copies(phi);
+    ir::basic_block* block = phi->get_parent();
+    for(ir::instruction* i: block->get_inst_list())
+      if(users.count(i)){
+        builder.set_insert_point(i);
+        break;
+      }
+    ir::value* cfs = builder.create_copy_from_shared(phi);
+    for(ir::user* u: users)
+      u->replace_uses_of_with(phi, cfs);
+  }
+  num_staged_loads_ = to_stage.size();
+
   // try to move dot_inst after loads
   // for better overlap of io and compute
   struct move_config_t{
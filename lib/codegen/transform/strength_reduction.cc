@@ -0,0 +1,293 @@
+#include "triton/codegen/transform/strength_reduction.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/type.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+inline bool is_in(ir::value* v, ir::basic_block* block) {
+  auto i = dynamic_cast<ir::instruction*>(v);
+  return i && i->get_parent() == block;
+}
+
+/// whether scalar `v` is known to be >= 0, in which case `max` is set to
+/// an upper bound of `v`. Sums and products are only bounded when they
+/// cannot wrap around, so that their sign is that of the exact result
+bool strength_reduction::is_nonneg(ir::value *v, uint64_t &max, std::map<ir::value*, uint64_t> &cache) {
+  if(v->get_type()->is_block_ty() || !v->get_type()->is_integer_ty())
+    return false;
+  unsigned bits = v->get_type()->get_integer_bitwidth();
+  uint64_t limit = (1ULL << (bits - 1)) - 1;
+  if(auto x = dynamic_cast<ir::constant_int*>(v)){
+    max = x->get_value() & ((limit << 1) | 1);
+    return max <= limit;
+  }
+  // loop-carried values that are not known to be >= 0 are cached as ~0
+  auto it = cache.find(v);
+  if(it != cache.end()){
+    max = it->second;
+    return max != ~0ULL;
+  }
+  // the grid has at most 2^31 - 1 programs along axis 0,
+  // and 65535 along the other ones
+  if(auto x = dynamic_cast<ir::get_program_id_inst*>(v)){
+    max = std::min<uint64_t>(x->get_axis() == 0 ? 0x7fffffff : 0xffff, limit);
+    return true;
+  }
+  if(auto x = dynamic_cast<ir::get_num_programs_inst*>(v)){
+    max = std::min<uint64_t>(x->get_axis() == 0 ? 0x7fffffff : 0xffff, limit);
+    return true;
+  }
+  // optimistic for loop-carried values: non-negative on entry
+  // and updated with non-negative values only. Their bound is
+  // unknown, so that incrementing them is never proven not to wrap
+  if(auto x = dynamic_cast<ir::phi_node*>(v)){
+    cache[x] = limit;
+    uint64_t tmp;
+    for(unsigned n = 0; n < x->get_num_incoming(); n++)
+      if(!is_nonneg(x->get_incoming_value(n), tmp, cache)){
+        cache[x] = ~0ULL;
+        return false;
+      }
+    max = limit;
+    return true;
+  }
+  if(auto x = dynamic_cast<ir::cast_inst*>(v)){
+    ir::value* arg = x->get_operand(0);
+    if(x->get_op() == ir::cast_op_t::ZExt){
+      unsigned arg_bits = arg->get_type()->get_integer_bitwidth();
+      max = arg_bits >= 64 ? ~0ULL : (1ULL << arg_bits) - 1;
+      return max <= limit;
+    }
+    if(x->get_op() == ir::cast_op_t::SExt)
+      return is_nonneg(arg, max, cache);
+    return false;
+  }
+  if(auto x = dynamic_cast<ir::binary_operator*>(v)){
+    ir::value* lhs = x->get_operand(0);
+    ir::value* rhs = x->get_operand(1);
+    uint64_t max_lhs = 0, max_rhs = 0;
+    bool lhs_nonneg = is_nonneg(lhs, max_lhs, cache);
+    bool rhs_nonneg = is_nonneg(rhs, max_rhs, cache);
+    switch(x->get_op()){
+      case ir::binary_op_t::Add:
+        max = max_lhs + max_rhs;
+        return lhs_nonneg && rhs_nonneg && max <= limit;
+      case ir::binary_op_t::Mul:
+        max = max_lhs * max_rhs;
+        return lhs_nonneg && rhs_nonneg && (max_lhs == 0 || max_rhs <= limit / max_lhs);
+      case ir::binary_op_t::SDiv:
+        max = max_lhs;
+        return lhs_nonneg && rhs_nonneg;
+      case ir::binary_op_t::SRem:
+      case ir::binary_op_t::AShr:
+      case ir::binary_op_t::UDiv:
+        max = max_lhs;
+        return lhs_nonneg;
+      case ir::binary_op_t::Or:
+        // bounded by the smallest 2^k - 1 above both operands
+        max = std::max(max_lhs, max_rhs);
+        for(unsigned k = 1; k < 64; k *= 2)
+          max |= max >> k;
+        return lhs_nonneg && rhs_nonneg;
+      case ir::binary_op_t::And:
+        max = lhs_nonneg && rhs_nonneg ? std::min(max_lhs, max_rhs) : lhs_nonneg ? max_lhs : max_rhs;
+        return lhs_nonneg || rhs_nonneg;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+/// (x * y) >> 32 for unsigned 32-bit x and y
+inline ir::value* mulhi(ir::value* x, ir::value* y, ir::builder& builder) {
+  ir::type* i64 = builder.get_int64_ty();
+  ir::value* wide = builder.create_mul(builder.create_cast(ir::cast_op_t::ZExt, x, i64),
+                                       builder.create_cast(ir::cast_op_t::ZExt, y, i64));
+  wide = builder.create_lshr(wide, builder.get_int64(32));
+  return builder.create_cast(ir::cast_op_t::Trunc, wide, x->get_type());
+}
+
+/// computes the divisor-only part of a division by scalar `d` right after
+/// the definition of `d`, so that it is shared by all divisions by `d` and
+/// hoisted out of the loops that do not define it. The inverse is a float
+/// reciprocal refined by one Newton-Raphson step, as in LLVM's expansion
+/// of 32-bit divisions for targets without an integer divider
+bool strength_reduction::get_inverse(ir::value *d, inverse_t &inv, ir::builder &builder) {
+  auto it = inverses_.find(d);
+  if(it != inverses_.end()){
+    inv = it->second;
+    return true;
+  }
+  if(auto i = dynamic_cast<ir::instruction*>(d)){
+    if(dynamic_cast<ir::phi_node*>(i))
+      builder.set_insert_point(i->get_parent()->get_first_non_phi());
+    else
+      builder.set_insert_point_after(i);
+  }
+  else if(auto arg = dynamic_cast<ir::argument*>(d))
+    builder.set_insert_point(arg->get_parent()->blocks()[0]->get_first_non_phi());
+  else
+    return false;
+  std::map<ir::value*, uint64_t> cache;
+  uint64_t max;
+  ir::value* zero = builder.get_int32(0);
+  inv.abs = d;
+  inv.neg = nullptr;
+  if(!is_nonneg(d, max, cache)){
+    inv.neg = builder.create_icmpSLT(d, zero);
+    inv.abs = builder.create_select(inv.neg, builder.create_sub(zero, d), d);
+  }
+  // |d| is treated as unsigned, so that |INT_MIN| = 2^31
+  ir::value* rcp = builder.create_cast(ir::cast_op_t::UIToFP, inv.abs, builder.get_float_ty());
+  rcp = builder.create_fdiv(builder.get_float32(1.f), rcp);
+  // scale by 2^32 - 512 (0x4f7ffffe) so that the estimate stays below 2^32 / |d|
+  rcp = builder.create_fmul(rcp, builder.get_float32(4294966784.f));
+  ir::value* z = builder.create_cast(ir::cast_op_t::FPToUI, rcp, d->get_type());
+  ir::value* neg_dz = builder.create_mul(builder.create_sub(zero, inv.abs), z);
+  inv.inv = builder.create_add(z, mulhi(z, neg_dz, builder));
+  inverses_[d] = inv;
+  return true;
+}
+
+bool strength_reduction::rewrite_div_rem(ir::instruction *i, ir::builder &builder) {
+  auto x = dynamic_cast<ir::binary_operator*>(i);
+  if(!x || x->get_type()->is_block_ty() || !x->get_type()->is_integer_ty(32))
+    return false;
+  bool is_div = x->get_op() == ir::binary_op_t::SDiv;
+  bool is_rem = x->get_op() == ir::binary_op_t::SRem;
+  if(!is_div && !is_rem)
+    return false;
+  ir::value* lhs = x->get_operand(0);
+  std::map<ir::value*, uint64_t> cache;
+  uint64_t max;
+  if(!is_nonneg(lhs, max, cache))
+    return false;
+  auto cst = dynamic_cast<ir::constant_int*>(x->get_operand(1));
+  int64_t d = cst ? (int32_t)cst->get_value() : 0;
+  inverse_t inv;
+  if(cst && d <= 0)
+    return false;
+  if(!cst && !get_inverse(x->get_operand(1), inv, builder))
+    return false;
+  builder.set_insert_point(x);
+  ir::value* result;
+  if(!cst){
+    // the estimate of lhs / |d| is at most 2 below the exact quotient
+    ir::value* q = mulhi(lhs, inv.inv, builder);
+    ir::value* r = builder.create_sub(lhs, builder.create_mul(q, inv.abs));
+    for(int n = 0; n < 2; n++){
+      ir::value* ge = builder.create_icmpUGE(r, inv.abs);
+      q = builder.create_select(ge, builder.create_add(q, builder.get_int32(1)), q);
+      r = builder.create_select(ge, builder.create_sub(r, inv.abs), r);
+    }
+    // the remainder has the sign of lhs, the quotient that of lhs * d
+    if(is_div && inv.neg)
+      q = builder.create_select(inv.neg, builder.create_sub(builder.get_int32(0), q), q);
+    result = is_div ? q : r;
+  }
+  else if(d == 1)
+    result = is_div ? lhs : builder.get_int32(0);
+  else if((d & (d - 1)) == 0){
+    int k = 0;
+    while((1LL << k) != d)
+      k++;
+    result = is_div ? builder.create_lshr(lhs, builder.get_int32(k))
+                    : builder.create_and(lhs, builder.get_int32(d - 1));
+  }
+  else {
+    // 0 <= lhs < 2^31: lhs / d == (lhs * m) >> (31 + l)
+    // with l = ceil(log2(d)) and m = ceil(2^(31 + l) / d) < 2^32
+    int l = 0;
+    while((1LL << l) < d)
+      l++;
+    int64_t m = ((1LL << (31 + l)) + d - 1) / d;
+    ir::type* i64 = builder.get_int64_ty();
+    ir::value* wide = builder.create_cast(ir::cast_op_t::ZExt, lhs, i64);
+    wide = builder.create_mul(wide, builder.get_int64(m));
+    wide = builder.create_lshr(wide, builder.get_int64(31 + l));
+    result = builder.create_cast(ir::cast_op_t::Trunc, wide, x->get_type());
+    if(is_rem)
+      result = builder.create_sub(lhs, builder.create_mul(result, builder.get_int32(d)));
+  }
+  x->replace_all_uses_with(result);
+  x->erase_from_parent();
+  num_div_rem_++;
+  return true;
+}
+
+bool strength_reduction::rewrite_iv_mul(ir::basic_block *loop, ir::builder &builder) {
+  // same loop shape as generated by the front-end for `for` statements
+  ir::instruction* loop_br = loop->get_inst_list().back();
+  const auto& preds = loop->get_predecessors();
+  if(preds.size() != 2)
+    return false;
+  ir::basic_block* header = preds[0] == loop ? preds[1] : preds[0];
+  ir::instruction* header_br = header->get_inst_list().back();
+  bool modified = false;
+  std::vector<ir::phi_node*> phis;
+  for(ir::instruction* i: loop->get_inst_list())
+    if(auto phi = dynamic_cast<ir::phi_node*>(i))
+      phis.push_back(phi);
+  for(ir::phi_node* phi: phis){
+    if(phi->get_type()->is_block_ty() || !phi->get_type()->is_integer_ty())
+      continue;
+    // phi = phi + step
+    auto next = dynamic_cast<ir::binary_operator*>(phi->get_value_for_block(loop));
+    if(!next || next->get_op() != ir::binary_op_t::Add || next->get_operand(0) != phi
+       || is_in(next->get_operand(1), loop))
+      continue;
+    ir::value* step = next->get_operand(1);
+    ir::value* init = phi->get_value_for_block(header);
+    // phi * scale, with loop-invariant scale
+    std::vector<ir::user*> users(phi->get_users().begin(), phi->get_users().end());
+    for(ir::user* u: users){
+      auto mul = dynamic_cast<ir::binary_operator*>(u);
+      if(!mul || mul->get_op() != ir::binary_op_t::Mul || mul->get_parent() != loop
+         || mul->get_type() != phi->get_type())
+        continue;
+      ir::value* scale = mul->get_operand(0) == phi ? mul->get_operand(1) : mul->get_operand(0);
+      if(scale == phi || is_in(scale, loop))
+        continue;
+      builder.set_insert_point(header_br);
+      ir::value* new_init = builder.create_mul(init, scale);
+      ir::value* new_step = builder.create_mul(step, scale);
+      builder.set_insert_point(*loop->begin());
+      ir::phi_node* new_phi = builder.create_phi(phi->get_type(), 2);
+      builder.set_insert_point(loop_br);
+      ir::value* new_next = builder.create_add(new_phi, new_step);
+      new_phi->add_incoming(new_init, header);
+      new_phi->add_incoming(new_next, loop);
+      mul->replace_all_uses_with(new_phi);
+      mul->erase_from_parent();
+      num_iv_mul_++;
+      modified = true;
+    }
+  }
+  return modified;
+}
+
+void strength_reduction::run(ir::module &mod) {
+  ir::builder &builder = mod.get_builder();
+  inverses_.clear();
+  for(ir::function *fn: mod.get_function_list())
+  for(ir::basic_block *block: fn->blocks()){
+    if(block->empty())
+      continue;
+    auto br = dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back());
+    if(br && br->get_true_dest() == block)
+      rewrite_iv_mul(block, builder);
+    std::vector<ir::instruction*> insts(block->begin(), block->end());
+    for(ir::instruction *i: insts)
+      rewrite_div_rem(i, builder);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include "triton/codegen/transform/unroll.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/type.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+typedef std::map<ir::value*, ir::value*> remap_t;
+
+inline ir::value* lookup(ir::value* v, const remap_t& remap) {
+  auto it = remap.find(v);
+  return it == remap.end() ? v : it->second;
+}
+
+inline int64_t sext(uint64_t x, unsigned bits) {
+  if(bits >= 64)
+    return (int64_t)x;
+  uint64_t m = 1ULL << (bits - 1);
+  x &= (1ULL << bits) - 1;
+  return (int64_t)((x ^ m) - m);
+}
+
+inline void set_incoming_value(ir::phi_node* phi, unsigned n, ir::value* v) {
+  ir::value* old = phi->get_incoming_value(n);
+  phi->set_incoming_value(n, v);
+  if(std::find(phi->op_begin(), phi->op_end(), old) == phi->op_end())
+    old->erase_use(phi);
+}
+
+/// constant-folds scalar integer computations, given the values of some phi-nodes
+bool unroll::evaluate(ir::value *v, env_t &env, int64_t &result) {
+  ir::type* ty = v->get_type();
+  if(!ty->is_integer_ty())
+    return false;
+  unsigned bits = ty->get_integer_bitwidth();
+  if(auto x = dynamic_cast<ir::constant_int*>(v)){
+    result = sext(x->get_value(), bits);
+    return true;
+  }
+  auto it = env.find(v);
+  if(it != env.end()){
+    result = it->second;
+    return true;
+  }
+  if(auto x = dynamic_cast<ir::binary_operator*>(v)){
+    int64_t lhs, rhs;
+    if(!evaluate(x->get_operand(0), env, lhs) || !evaluate(x->get_operand(1), env, rhs))
+      return false;
+    // wrapping arithmetic is done on unsigned integers, and the operations
+    // whose result is undefined are not folded
+    int64_t min = sext(1ULL << (std::min(bits, 64u) - 1), bits);
+    bool div_undef = rhs == 0 || (rhs == -1 && lhs == min);
+    bool shift_undef = rhs < 0 || rhs >= bits;
+    switch(x->get_op()){
+      case ir::binary_op_t::Add: result = (uint64_t)lhs + (uint64_t)rhs; break;
+      case ir::binary_op_t::Sub: result = (uint64_t)lhs - (uint64_t)rhs; break;
+      case ir::binary_op_t::Mul: result = (uint64_t)lhs * (uint64_t)rhs; break;
+      case ir::binary_op_t::SDiv: if(div_undef) return false; result = lhs / rhs; break;
+      case ir::binary_op_t::SRem: if(div_undef) return false; result = lhs % rhs; break;
+      case ir::binary_op_t::Shl: if(shift_undef) return false; result = (uint64_t)lhs << rhs; break;
+      case ir::binary_op_t::AShr: if(shift_undef) return false; result = lhs >> rhs; break;
+      case ir::binary_op_t::And: result = lhs & rhs; break;
+      case ir::binary_op_t::Or: result = lhs | rhs; break;
+      case ir::binary_op_t::Xor: result = lhs ^ rhs; break;
+      default: return false;
+    }
+    result = sext(result, bits);
+    return true;
+  }
+  if(auto x = dynamic_cast<ir::icmp_inst*>(v)){
+    int64_t lhs, rhs;
+    if(!evaluate(x->get_operand(0), env, lhs) || !evaluate(x->get_operand(1), env, rhs))
+      return false;
+    unsigned op_bits = x->get_operand(0)->get_type()->get_integer_bitwidth();
+    uint64_t mask = op_bits >= 64 ? ~0ULL : (1ULL << op_bits) - 1;
+    uint64_t ulhs = (uint64_t)lhs & mask;
+    uint64_t urhs = (uint64_t)rhs & mask;
+    switch(x->get_pred()){
+      case ir::ICMP_EQ:  result = lhs == rhs; break;
+      case ir::ICMP_NE:  result = lhs != rhs; break;
+      case ir::ICMP_SLT: result = lhs < rhs; break;
+      case ir::ICMP_SLE: result = lhs <= rhs; break;
+      case ir::ICMP_SGT: result = lhs > rhs; break;
+      case ir::ICMP_SGE: result = lhs >= rhs; break;
+      case ir::ICMP_ULT: result = ulhs < urhs; break;
+      case ir::ICMP_ULE: result = ulhs <= urhs; break;
+      case ir::ICMP_UGT: result = ulhs > urhs; break;
+      case ir::ICMP_UGE: result = ulhs >= urhs; break;
+      default: return false;
+    }
+    return true;
+  }
+  if(auto x = dynamic_cast<ir::select_inst*>(v)){
+    int64_t pred;
+    if(!evaluate(x->get_pred_op(), env, pred))
+      return false;
+    return evaluate(pred ? x->get_if_value_op() : x->get_else_value_op(), env, result);
+  }
+  if(auto x = dynamic_cast<ir::cast_inst*>(v)){
+    int64_t arg;
+    if(!evaluate(x->get_operand(0), env, arg))
+      return false;
+    unsigned arg_bits = x->get_operand(0)->get_type()->get_integer_bitwidth();
+    switch(x->get_op()){
+      case ir::cast_op_t::SExt: result = arg; break;
+      case ir::cast_op_t::ZExt: result = arg_bits >= 64 ? arg : (int64_t)((uint64_t)arg & ((1ULL << arg_bits) - 1)); break;
+      case ir::cast_op_t::Trunc: result = sext(arg, bits); break;
+      default: return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+/// number of times the body of `loop` executes, or -1 if unknown
+int unroll::trip_count(ir::basic_block *loop, ir::basic_block *header, int max_trips) {
+  auto* header_br = static_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
+  auto* loop_br = static_cast<ir::cond_branch_inst*>(loop->get_inst_list().back());
+  std::vector<ir::phi_node*> phis;
+  for(ir::instruction* i: loop->get_inst_list())
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      phis.push_back(phi);
+  env_t env;
+  int64_t cond;
+  if(!evaluate(header_br->get_cond(), env, cond))
+    return -1;
+  if(!cond)
+    return 0;
+  env_t empty;
+  for(ir::phi_node* phi: phis){
+    int64_t init;
+    if(evaluate(phi->get_value_for_block(header), empty, init))
+      env[phi] = init;
+  }
+  for(int n = 1; n <= max_trips; n++){
+    if(!evaluate(loop_br->get_cond(), env, cond))
+      return -1;
+    if(!cond)
+      return n;
+    env_t next;
+    for(ir::phi_node* phi: phis){
+      int64_t val;
+      if(evaluate(phi->get_value_for_block(loop), env, val))
+        next[phi] = val;
+    }
+    env = next;
+  }
+  return -1;
+}
+
+void unroll::full_unroll(ir::basic_block *loop, ir::basic_block *header, ir::basic_block *exit, int num_trips, ir::builder &builder) {
+  auto* loop_br = static_cast<ir::cond_branch_inst*>(loop->get_inst_list().back());
+  auto* header_br = static_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
+  std::vector<ir::phi_node*> phis;
+  std::vector<ir::instruction*> body;
+  for(ir::instruction* i: loop->get_inst_list()){
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      phis.push_back(phi);
+    else if(i != loop_br)
+      body.push_back(i);
+  }
+  // clone body `num_trips` times
+  remap_t remap;
+  for(ir::phi_node* phi: phis)
+    remap[phi] = phi->get_value_for_block(header);
+  builder.set_insert_point(loop_br);
+  for(int n = 0; n < num_trips; n++){
+    if(n > 0){
+      remap_t next;
+      for(ir::phi_node* phi: phis)
+        next[phi] = lookup(phi->get_value_for_block(loop), remap);
+      for(ir::phi_node* phi: phis)
+        remap[phi] = next[phi];
+    }
+    for(ir::instruction* i: body){
+      ir::instruction* cloned = i->clone();
+      for(size_t k = 0; k < i->get_num_operands(); k++)
+        cloned->set_operand(k, lookup(i->get_operand(k), remap));
+      builder.insert(cloned);
+      remap[i] = cloned;
+    }
+  }
+  // values escaping the loop
+  std::vector<ir::phi_node*> exit_phis;
+  for(ir::instruction* i: exit->get_inst_list())
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      exit_phis.push_back(phi);
+  for(ir::phi_node* phi: exit_phis){
+    phi->replace_all_uses_with(lookup(phi->get_value_for_block(loop), remap));
+    phi->erase_from_parent();
+  }
+  // remove the original loop
+  for(ir::instruction* i: body)
+    i->erase_from_parent();
+  for(ir::phi_node* phi: phis)
+    phi->erase_from_parent();
+  loop_br->erase_from_parent();
+  builder.set_insert_point(loop);
+  builder.insert(ir::branch_inst::create(exit));
+  header_br->erase_from_parent();
+  builder.set_insert_point(header);
+  builder.insert(ir::branch_inst::create(loop));
+  loop->remove_predecessor(loop);
+  exit->remove_predecessor(header);
+}
+
+void unroll::partial_unroll(ir::basic_block *loop, ir::basic_block *exit, int factor, ir::builder &builder) {
+  auto* loop_br = static_cast<ir::cond_branch_inst*>(loop->get_inst_list().back());
+  std::vector<ir::phi_node*> phis;
+  std::vector<ir::instruction*> body;
+  for(ir::instruction* i: loop->get_inst_list()){
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      phis.push_back(phi);
+    else if(i != loop_br)
+      body.push_back(i);
+  }
+  // the original body is the first copy; the trip count being
+  // a multiple of `factor`, no intermediate exit is needed
+  remap_t remap;
+  builder.set_insert_point(loop_br);
+  for(int n = 1; n < factor; n++){
+    remap_t next;
+    for(ir::phi_node* phi: phis)
+      next[phi] = lookup(phi->get_value_for_block(loop), remap);
+    for(ir::phi_node* phi: phis)
+      remap[phi] = next[phi];
+    for(ir::instruction* i: body){
+      ir::instruction* cloned = i->clone();
+      for(size_t k = 0; k < i->get_num_operands(); k++)
+        cloned->set_operand(k, lookup(i->get_operand(k), remap));
+      builder.insert(cloned);
+      remap[i] = cloned;
+    }
+  }
+  // rewire latch values, loop condition and escaping values to the last copy
+  std::vector<ir::value*> latches;
+  for(ir::phi_node* phi: phis)
+    latches.push_back(lookup(phi->get_value_for_block(loop), remap));
+  for(size_t k = 0; k < phis.size(); k++)
+  for(unsigned n = 0; n < phis[k]->get_num_incoming(); n++)
+    if(phis[k]->get_incoming_block(n) == loop)
+      set_incoming_value(phis[k], n, latches[k]);
+  loop_br->replace_uses_of_with(loop_br->get_cond(), lookup(loop_br->get_cond(), remap));
+  for(ir::instruction* i: exit->get_inst_list()){
+    auto* phi = dynamic_cast<ir::phi_node*>(i);
+    if(!phi)
+      continue;
+    for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+      if(phi->get_incoming_block(n) == loop)
+        set_incoming_value(phi, n, lookup(phi->get_incoming_value(n), remap));
+  }
+}
+
+// dots and loads through a pointer phi are left to the pipeline pass,
+// which needs the loop to be intact in order to prefetch across iterations
+inline bool has_pipeline_candidates(ir::basic_block* loop) {
+  for(ir::instruction* i: loop->get_inst_list()){
+    if(dynamic_cast<ir::dot_inst*>(i))
+      return true;
+    auto* load = dynamic_cast<ir::load_inst*>(i);
+    if(!load || !load->get_type()->is_block_ty())
+      continue;
+    auto* ptr = dynamic_cast<ir::phi_node*>(load->get_pointer_operand());
+    if(ptr && ptr->get_parent() == loop)
+      return true;
+  }
+  return false;
+}
+
+bool unroll::run(ir::basic_block *loop, ir::builder &builder) {
+  // same loop shape as generated by the front-end for `for` statements:
+  //   header: ... ; br cond0, loop, exit
+  //   loop:   phis ; body ; br cond, loop, exit
+  auto* loop_br = dynamic_cast<ir::cond_branch_inst*>(loop->get_inst_list().back());
+  if(!loop_br || loop_br->get_true_dest() != loop || loop_br->get_false_dest() == loop)
+    return false;
+  ir::basic_block* exit = loop_br->get_false_dest();
+  const auto& preds = loop->get_predecessors();
+  if(preds.size() != 2 || exit->get_predecessors().size() != 2)
+    return false;
+  ir::basic_block* header = preds[0] == loop ? preds[1] : preds[0];
+  auto* header_br = dynamic_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
+  if(!header_br || header_br->get_true_dest() != loop || header_br->get_false_dest() != exit)
+    return false;
+  if(has_pipeline_candidates(loop))
+    return false;
+  // values defined in the loop may only escape through phi-nodes of the exit block
+  size_t size = 0;
+  for(ir::instruction* i: loop->get_inst_list()){
+    if(!dynamic_cast<ir::phi_node*>(i) && i != loop_br)
+      size++;
+    for(ir::user* u: i->get_users()){
+      auto* inst = dynamic_cast<ir::instruction*>(u);
+      if(inst->get_parent() == loop)
+        continue;
+      if(!dynamic_cast<ir::phi_node*>(u) || inst->get_parent() != exit)
+        return false;
+    }
+  }
+  int num_trips = trip_count(loop, header, max_trips_);
+  if(num_trips < 1 || size == 0)
+    return false;
+  if(num_trips * size <= max_size_){
+    full_unroll(loop, header, exit, num_trips, builder);
+    return true;
+  }
+  for(int factor = std::min<int>(max_size_ / size, num_trips / 2); factor >= 2; factor--)
+    if(num_trips % factor == 0){
+      partial_unroll(loop, exit, factor, builder);
+      return true;
+    }
+  return false;
+}
+
+void unroll::run(ir::module &mod) {
+  ir::builder &builder = mod.get_builder();
+  for(ir::function *fn: mod.get_function_list()){
+    std::vector<ir::basic_block*> loops;
+    for(ir::basic_block *block: fn->blocks()){
+      if(block->empty())
+        continue;
+      auto* br = dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back());
+      if(br && br->get_true_dest() == block)
+        loops.push_back(block);
+    }
+    for(ir::basic_block *loop: loops)
+      num_unrolled_loops_ += run(loop, builder);
+  }
+}
+
+}
+}
+}
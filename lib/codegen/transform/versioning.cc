@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <stdexcept>
+#include "triton/codegen/transform/versioning.h"
+#include "triton/ir/module.h"
+#include "triton/ir/function.h"
+#include "triton/ir/basic_block.h"
+#include "triton/ir/instructions.h"
+#include "triton/ir/utils.h"
+
+namespace triton {
+namespace codegen{
+namespace transform{
+
+inline ir::value* lookup(ir::value* v, const std::map<ir::value*, ir::value*>& remap) {
+  auto it = remap.find(v);
+  return it == remap.end() ? v : it->second;
+}
+
+inline bool is_in(ir::value* v, ir::basic_block* block) {
+  auto i = dynamic_cast<ir::instruction*>(v);
+  return i && i->get_parent() == block;
+}
+
+inline bool is_lt_pred(ir::cmp_pred_t pred) {
+  return pred == ir::ICMP_SLT || pred == ir::ICMP_SLE;
+}
+
+inline bool is_gt_pred(ir::cmp_pred_t pred) {
+  return pred == ir::ICMP_SGT || pred == ir::ICMP_SGE;
+}
+
+/// values defined outside of the loop
+bool versioning::is_invariant(ir::value *v, ir::basic_block *loop) {
+  return !is_in(v, loop);
+}
+
+/// whether `v` (transitively) depends on a phi-node of the loop
+bool versioning::depends_on_loop(ir::value *v, ir::basic_block *loop) {
+  if(!is_in(v, loop))
+    return false;
+  if(dynamic_cast<ir::phi_node*>(v))
+    return true;
+  auto i = static_cast<ir::instruction*>(v);
+  return std::any_of(i->op_begin(), i->op_end(),
+                     [&](ir::value* op){ return depends_on_loop(op, loop); });
+}
+
+/// whether the range of values taken by the elements of `v`
+/// can be computed as scalars from loop phis and loop invariants
+bool versioning::can_bound(ir::value *v, ir::basic_block *loop) {
+  if(is_invariant(v, loop) && !v->get_type()->is_block_ty())
+    return true;
+  if(dynamic_cast<ir::make_range*>(v))
+    return true;
+  // scalars: must be side-effect free so they can be rematerialized
+  if(!v->get_type()->is_block_ty()){
+    if(dynamic_cast<ir::phi_node*>(v))
+      return true;
+    if(!dynamic_cast<ir::binary_operator*>(v) &&
+       !dynamic_cast<ir::cast_inst*>(v) &&
+       !dynamic_cast<ir::cmp_inst*>(v) &&
+       !dynamic_cast<ir::select_inst*>(v))
+      return false;
+    auto i = static_cast<ir::instruction*>(v);
+    return std::all_of(i->op_begin(), i->op_end(),
+                       [&](ir::value* op){ return can_bound(op, loop); });
+  }
+  if(auto x = dynamic_cast<ir::splat_inst*>(v))
+    return can_bound(x->get_operand(0), loop);
+  if(dynamic_cast<ir::broadcast_inst*>(v) || dynamic_cast<ir::reshape_inst*>(v))
+    return can_bound(static_cast<ir::instruction*>(v)->get_operand(0), loop);
+  if(auto x = dynamic_cast<ir::binary_operator*>(v)){
+    ir::value* lhs = x->get_operand(0);
+    ir::value* rhs = x->get_operand(1);
+    if(x->get_op() == ir::binary_op_t::Add || x->get_op() == ir::binary_op_t::Sub)
+      return can_bound(lhs, loop) && can_bound(rhs, loop);
+    // multiplication by a non-negative constant preserves ordering
+    if(x->get_op() == ir::binary_op_t::Mul){
+      auto splat = dynamic_cast<ir::splat_inst*>(rhs);
+      auto cst = splat ? dynamic_cast<ir::constant_int*>(splat->get_operand(0)) : nullptr;
+      return cst && cst->get_value() < (1ULL << 31) && can_bound(lhs, loop);
+    }
+  }
+  return false;
+}
+
+/// whether `mask` only depends on the induction variables of `loop`
+/// in a way that lets us test at run-time whether it is all-true
+bool versioning::can_version(ir::value *mask, ir::basic_block *loop) {
+  if(dynamic_cast<ir::broadcast_inst*>(mask) || dynamic_cast<ir::reshape_inst*>(mask))
+    return can_version(static_cast<ir::instruction*>(mask)->get_operand(0), loop);
+  if(auto x = dynamic_cast<ir::binary_operator*>(mask))
+    return x->get_op() == ir::binary_op_t::And &&
+           can_version(x->get_operand(0), loop) &&
+           can_version(x->get_operand(1), loop);
+  auto cmp = dynamic_cast<ir::icmp_inst*>(mask);
+  if(!cmp)
+    return false;
+  if(!is_lt_pred(cmp->get_pred()) && !is_gt_pred(cmp->get_pred()))
+    return false;
+  return depends_on_loop(cmp, loop) &&
+         can_bound(cmp->get_operand(0), loop) &&
+         can_bound(cmp->get_operand(1), loop);
+}
+
+/// clone the scalar computation of `v` at the builder's insertion point,
+/// substituting values according to `remap` (which must contain all loop phis)
+ir::value* versioning::rematerialize(ir::value *v, ir::basic_block *loop, remap_t &remap, ir::builder &builder) {
+  if(remap.find(v) != remap.end())
+    return remap.at(v);
+  if(is_invariant(v, loop))
+    return v;
+  ir::instruction* i = static_cast<ir::instruction*>(v);
+  assert(!dynamic_cast<ir::phi_node*>(i));
+  std::vector<ir::value*> new_ops;
+  for(ir::value* op: i->ops())
+    new_ops.push_back(rematerialize(op, loop, remap, builder));
+  ir::instruction* ret = i->clone();
+  for(size_t k = 0; k < new_ops.size(); k++)
+    ret->set_operand(k, new_ops[k]);
+  builder.insert(ret);
+  return remap[v] = ret;
+}
+
+/// scalar lower (resp. upper) bound of the elements of `v`
+ir::value* versioning::bound(ir::value *v, bool is_max, ir::basic_block *loop, remap_t &remap, ir::builder &builder) {
+  if(!v->get_type()->is_block_ty())
+    return rematerialize(v, loop, remap, builder);
+  if(auto x = dynamic_cast<ir::make_range*>(v)){
+    ir::type* ty = x->get_type()->get_scalar_ty();
+    uint64_t value = is_max ? x->get_last()->get_value() - 1 : x->get_first()->get_value();
+    return ir::constant_int::get(ty, value);
+  }
+  if(auto x = dynamic_cast<ir::splat_inst*>(v))
+    return rematerialize(x->get_operand(0), loop, remap, builder);
+  if(dynamic_cast<ir::broadcast_inst*>(v) || dynamic_cast<ir::reshape_inst*>(v))
+    return bound(static_cast<ir::instruction*>(v)->get_operand(0), is_max, loop, remap, builder);
+  auto x = static_cast<ir::binary_operator*>(v);
+  ir::value* lhs = x->get_operand(0);
+  ir::value* rhs = x->get_operand(1);
+  switch(x->get_op()){
+    case ir::binary_op_t::Add:
+      return builder.create_add(bound(lhs, is_max, loop, remap, builder),
+                                bound(rhs, is_max, loop, remap, builder));
+    case ir::binary_op_t::Sub:
+      return builder.create_sub(bound(lhs, is_max, loop, remap, builder),
+                                bound(rhs, !is_max, loop, remap, builder));
+    case ir::binary_op_t::Mul:
+      return builder.create_mul(bound(lhs, is_max, loop, remap, builder),
+                                static_cast<ir::splat_inst*>(rhs)->get_operand(0));
+    default:
+      throw std::runtime_error("unreachable");
+  }
+}
+
+/// scalar predicate that is true iff all the elements of `mask` are true
+ir::value* versioning::all_true(ir::value *mask, ir::basic_block *loop, remap_t &remap, ir::builder &builder) {
+  if(dynamic_cast<ir::broadcast_inst*>(mask) || dynamic_cast<ir::reshape_inst*>(mask))
+    return all_true(static_cast<ir::instruction*>(mask)->get_operand(0), loop, remap, builder);
+  if(auto x = dynamic_cast<ir::binary_operator*>(mask))
+    return builder.create_and(all_true(x->get_operand(0), loop, remap, builder),
+                              all_true(x->get_operand(1), loop, remap, builder));
+  auto cmp = static_cast<ir::icmp_inst*>(mask);
+  bool lhs_max = is_lt_pred(cmp->get_pred());
+  ir::value* lhs = bound(cmp->get_operand(0), lhs_max, loop, remap, builder);
+  ir::value* rhs = bound(cmp->get_operand(1), !lhs_max, loop, remap, builder);
+  return builder.create_icmp(cmp->get_pred(), lhs, rhs);
+}
+
+ir::value* versioning::all_true(const std::vector<ir::value*> &masks, ir::basic_block *loop, remap_t &remap, ir::builder &builder) {
+  ir::value* ret = nullptr;
+  for(ir::value* mask: masks){
+    ir::value* curr = all_true(mask, loop, remap, builder);
+    ret = ret ? builder.create_and(ret, curr) : curr;
+  }
+  return ret;
+}
+
+bool versioning::run(ir::basic_block *loop, ir::builder &builder) {
+  // the loop must look like what the front-end generates for `for` statements:
+  //   header: ... ; br cond0, loop, exit
+  //   loop:   phis ; body ; br cond, loop, exit
+  auto* loop_br = dynamic_cast<ir::cond_branch_inst*>(loop->get_inst_list().back());
+  if(!loop_br || loop_br->get_true_dest() != loop || loop_br->get_false_dest() == loop)
+    return false;
+  ir::basic_block* exit = loop_br->get_false_dest();
+  const auto& preds = loop->get_predecessors();
+  if(preds.size() != 2 || exit->get_predecessors().size() != 2)
+    return false;
+  ir::basic_block* header = preds[0] == loop ? preds[1] : preds[0];
+  auto* header_br = dynamic_cast<ir::cond_branch_inst*>(header->get_inst_list().back());
+  if(!header_br || header_br->get_true_dest() != loop || header_br->get_false_dest() != exit)
+    return false;
+  const auto& exit_preds = exit->get_predecessors();
+  if(std::find(exit_preds.begin(), exit_preds.end(), header) == exit_preds.end())
+    return false;
+  // split loop into phi-nodes and body
+  std::vector<ir::phi_node*> phis;
+  std::vector<ir::instruction*> body;
+  for(ir::instruction* i: loop->get_inst_list()){
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      phis.push_back(phi);
+    else if(i != loop_br)
+      body.push_back(i);
+  }
+  // values defined in the loop may only escape through phi-nodes of the exit block
+  std::vector<ir::phi_node*> exit_phis;
+  for(ir::instruction* i: exit->get_inst_list())
+    if(auto* phi = dynamic_cast<ir::phi_node*>(i))
+      exit_phis.push_back(phi);
+  for(ir::instruction* i: loop->get_inst_list())
+  for(ir::user* u: i->get_users()){
+    if(is_in(u, loop))
+      continue;
+    auto* phi = dynamic_cast<ir::phi_node*>(u);
+    if(!phi || phi->get_parent() != exit)
+      return false;
+  }
+  // find masks that can be proven all-true at run-time
+  std::map<ir::instruction*, ir::value*> to_unmask;
+  std::vector<ir::value*> masks;
+  for(ir::instruction* i: body){
+    ir::value* mask = nullptr;
+    if(auto* x = dynamic_cast<ir::masked_load_inst*>(i))
+      mask = x->get_mask_operand();
+    if(auto* x = dynamic_cast<ir::masked_store_inst*>(i))
+      mask = x->get_mask_operand();
+    if(!mask || !can_version(mask, loop))
+      continue;
+    to_unmask[i] = mask;
+    if(std::find(masks.begin(), masks.end(), mask) == masks.end())
+      masks.push_back(mask);
+  }
+  if(masks.empty())
+    return false;
+
+  ir::context& ctx = loop->get_context();
+  ir::function* fn = loop->get_parent();
+  ir::basic_block* main = ir::basic_block::create(ctx, loop->get_name() + ".unmasked", fn, loop);
+  ir::basic_block* guard = ir::basic_block::create(ctx, loop->get_name() + ".guard", fn, loop);
+
+  // header: enter the unmasked loop if the first iteration needs no mask
+  ir::value* cond0 = header_br->get_cond();
+  builder.set_insert_point(header_br);
+  remap_t first;
+  for(ir::phi_node* phi: phis)
+    first[phi] = phi->get_value_for_block(header);
+  ir::value* enter = builder.create_and(cond0, all_true(masks, loop, first, builder));
+  builder.create_cond_br(enter, main, guard);
+  header_br->erase_from_parent();
+
+  // unmasked loop
+  remap_t remap;
+  builder.set_insert_point(main);
+  std::vector<ir::phi_node*> main_phis;
+  for(ir::phi_node* phi: phis){
+    ir::phi_node* main_phi = builder.create_phi(phi->get_type(), 2);
+    main_phi->add_incoming(phi->get_value_for_block(header), header);
+    main_phis.push_back(main_phi);
+    remap[phi] = main_phi;
+  }
+  for(ir::instruction* i: body){
+    ir::instruction* cloned;
+    if(to_unmask.find(i) != to_unmask.end()){
+      ir::value* ptr = lookup(i->get_operand(0), remap);
+      if(dynamic_cast<ir::masked_load_inst*>(i))
+        cloned = ir::unmasked_load_inst::create(ptr);
+      else
+        cloned = ir::unmasked_store_inst::create(ptr, lookup(i->get_operand(1), remap));
+      auto *io = static_cast<ir::io_inst*>(i);
+      static_cast<ir::io_inst*>(cloned)->set_cache_hints(io->get_cache_modifier(), io->get_eviction_policy());
+    }
+    else{
+      cloned = i->clone();
+      for(size_t k = 0; k < i->get_num_operands(); k++)
+        cloned->set_operand(k, lookup(i->get_operand(k), remap));
+    }
+    builder.insert(cloned);
+    remap[i] = cloned;
+  }
+  for(size_t k = 0; k < phis.size(); k++)
+    main_phis[k]->add_incoming(lookup(phis[k]->get_value_for_block(loop), remap), main);
+  // continue only if the next iteration needs no mask either
+  remap_t next;
+  for(size_t k = 0; k < phis.size(); k++)
+    next[phis[k]] = main_phis[k]->get_incoming_value(1);
+  ir::value* main_cond = lookup(loop_br->get_cond(), remap);
+  ir::value* cont = builder.create_and(main_cond, all_true(masks, loop, next, builder));
+  builder.create_cond_br(cont, main, guard);
+
+  // guard: merge state coming from the header and from the unmasked loop
+  builder.set_insert_point(guard);
+  for(ir::phi_node* phi: phis){
+    ir::phi_node* guard_phi = builder.create_phi(phi->get_type(), 2);
+    guard_phi->add_incoming(phi->get_value_for_block(header), header);
+    guard_phi->add_incoming(lookup(phi->get_value_for_block(loop), remap), main);
+    for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+    if(phi->get_incoming_block(n) == header){
+      phi->set_incoming_value(n, guard_phi);
+      phi->set_incoming_block(n, guard);
+    }
+  }
+  for(ir::phi_node* phi: exit_phis){
+    ir::phi_node* guard_phi = builder.create_phi(phi->get_type(), 2);
+    guard_phi->add_incoming(phi->get_value_for_block(header), header);
+    guard_phi->add_incoming(lookup(phi->get_value_for_block(loop), remap), main);
+    for(unsigned n = 0; n < phi->get_num_incoming(); n++)
+    if(phi->get_incoming_block(n) == header){
+      phi->set_incoming_value(n, guard_phi);
+      phi->set_incoming_block(n, guard);
+    }
+  }
+  ir::phi_node* guard_cond = builder.create_phi(cond0->get_type(), 2);
+  guard_cond->add_incoming(cond0, header);
+  guard_cond->add_incoming(main_cond, main);
+  builder.insert(ir::branch_inst::create(guard_cond, loop, exit));
+  loop->replace_predecessor(header, guard);
+  exit->replace_predecessor(header, guard);
+  return true;
+}
+
+void versioning::run(ir::module &mod) {
+  ir::builder &builder = mod.get_builder();
+  num_versioned_loops_ = 0;
+  for(ir::function *fn: mod.get_function_list()){
+    // collect candidates first since versioning creates new loops
+    std::vector<ir::basic_block*> loops;
+    for(ir::basic_block *block: fn->blocks()){
+      if(block->empty())
+        continue;
+      auto* br = dynamic_cast<ir::cond_branch_inst*>(block->get_inst_list().back());
+      if(br && br->get_true_dest() == block)
+        loops.push_back(block);
+    }
+    for(ir::basic_block *loop: loops)
+      num_versioned_loops_ += run(loop, builder);
+  }
+}
+
+}
+}
+}
@@ -223,6 +223,7 @@ static bool find_and_replace(std::string& str, const std::string& begin, const s
 //};
 
 int vptx(int version){
+  if(version >= 11040) return 74;
   if(version >= 11030) return 73;
   if(version >= 11020) return 72;
   if(version >= 11010) return 71;
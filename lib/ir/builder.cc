@@ -273,20 +273,30 @@ DEFINE_FCMP_INSTR(UNE, cmp_pred_t::FCMP_UNE)
 //                               load/store instructions
 //===----------------------------------------------------------------------===//
 
-value *builder::create_load(value *ptr){
-  return insert(unmasked_load_inst::create(ptr));
+value *builder::create_load(value *ptr, io_inst::CACHE_MODIFIER cache, io_inst::EVICTION_POLICY eviction){
+  io_inst *ret = insert(unmasked_load_inst::create(ptr));
+  ret->set_cache_hints(cache, eviction);
+  return ret;
 }
 
-value *builder::create_store(value *ptr, value *val){
-  return insert(unmasked_store_inst::create(ptr, val));
+value *builder::create_store(value *ptr, value *val, io_inst::CACHE_MODIFIER cache, io_inst::EVICTION_POLICY eviction){
+  io_inst *ret = insert(unmasked_store_inst::create(ptr, val));
+  ret->set_cache_hints(cache, eviction);
+  return ret;
 }
 
-value *builder::create_masked_load(value *ptr, value *mask, value *false_value){
-  return insert(masked_load_inst::create(ptr, mask, false_value));
+value *builder::create_masked_load(value *ptr, value *mask, value *false_value,
+                                   io_inst::CACHE_MODIFIER cache, io_inst::EVICTION_POLICY eviction){
+  io_inst *ret = insert(masked_load_inst::create(ptr, mask, false_value));
+  ret->set_cache_hints(cache, eviction);
+  return ret;
 }
 
-value *builder::create_masked_store(value *ptr, value *val, value *mask){
-  return insert(masked_store_inst::create(ptr, val, mask));
+value *builder::create_masked_store(value *ptr, value *val, value *mask,
+                                    io_inst::CACHE_MODIFIER cache, io_inst::EVICTION_POLICY eviction){
+  io_inst *ret = insert(masked_store_inst::create(ptr, val, mask));
+  ret->set_cache_hints(cache, eviction);
+  return ret;
 }
 
 //===----------------------------------------------------------------------===//
@@ -349,8 +359,34 @@ value *builder::create_log(value *arg){
   return insert(log_inst::create(arg));
 }
 
-value *builder::create_dot(value *A, value *B, value *C) {
-  return insert(dot_inst::create_nn(A, B, C));
+value *builder::create_exp2(value *arg, bool approx){
+  return insert(exp2_inst::create(arg, approx));
+}
+
+value *builder::create_tanh(value *arg, bool approx){
+  return insert(tanh_inst::create(arg, approx));
+}
+
+value *builder::create_erf(value *arg, bool approx){
+  return insert(erf_inst::create(arg, approx));
+}
+
+value *builder::create_sigmoid(value *arg, bool approx){
+  return insert(sigmoid_inst::create(arg, approx));
+}
+
+value *builder::create_rsqrt(value *arg, bool approx){
+  return insert(rsqrt_inst::create(arg, approx));
+}
+
+value *builder::create_pow(value *x, value *y, bool approx){
+  return insert(pow_inst::create(x, y, approx));
+}
+
+value *builder::create_dot(value *A, value *B, value *C, bool allow_tf32) {
+  dot_inst *dot = (dot_inst*)dot_inst::create_nn(A, B, C);
+  dot->set_allow_tf32(allow_tf32);
+  return insert(dot);
 }
 
 value *builder::create_trans(value *A, const std::vector<int>& perm) {
@@ -365,6 +401,10 @@ value *builder::create_reduce(value *A, reduce_inst::op_t op, unsigned axis) {
   return insert(reduce_inst::create(A, op, axis));
 }
 
+value *builder::create_scan(value *A, scan_inst::op_t op, unsigned axis, bool exclusive) {
+  return insert(scan_inst::create(A, op, axis, exclusive));
+}
+
 value *builder::create_select(value *pred, value *if_value, value *else_value){
   return insert(select_inst::create(pred, if_value, else_value));
 }
@@ -383,8 +423,11 @@ value *builder::create_copy_from_shared(value *arg) {
   return insert(copy_from_shared_inst::create(arg));
 }
 
-value *builder::create_masked_load_async(value *ptr, value *mask, value *false_value) {
-  return insert(masked_load_async_inst::create(ptr, mask, false_value));
+value *builder::create_masked_load_async(value *ptr, value *mask, value *false_value,
+                                         io_inst::CACHE_MODIFIER cache, io_inst::EVICTION_POLICY eviction) {
+  io_inst *ret = insert(masked_load_async_inst::create(ptr, mask, false_value));
+  ret->set_cache_hints(cache, eviction);
+  return ret;
 }
 
 value *builder::create_barrier(const std::string &name) {
@@ -43,13 +43,18 @@ ir::type *computation_type(ir::type* a_ty, ir::type* b_ty){
   //    converted to float
   if(a_ty->is_fp32_ty() || b_ty->is_fp32_ty())
     return type::get_fp32_ty(ctx);
-  // 3 ) if one operand is half, the other is implicitly
+  // 3 ) bf16 is only closed under itself; mixing it with
+  //     any other type promotes to float
+  if(a_ty->is_bf16_ty() || b_ty->is_bf16_ty())
+    return (a_ty->is_bf16_ty() && b_ty->is_bf16_ty()) ? type::get_bf16_ty(ctx)
+                                                      : type::get_fp32_ty(ctx);
+  // 4 ) if one operand is half, the other is implicitly
   //     converted to half
   if(a_ty->is_fp16_ty() || b_ty->is_fp16_ty())
     return type::get_fp16_ty(ctx);
   if(!a_ty->is_integer_ty() || !b_ty->is_integer_ty())
     throw_unreachable("augment_types");
-  // 4 ) both operands are integer and undergo
+  // 5 ) both operands are integer and undergo
   //    integer promotion
   return integer_promote(a_ty, b_ty);
 }
@@ -488,9 +493,40 @@ ir::value *dispatch::cast(ir::value *input, ir::type *dst_ty, ir::builder *build
 //                               Memory Operators
 //===----------------------------------------------------------------------===//
 
-ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir::builder* builder) {
+ir::io_inst::CACHE_MODIFIER cache_modifier(const std::string& name, bool is_load) {
+  if(name.empty())
+    return ir::io_inst::NONE;
+  if(name == ".cg")
+    return ir::io_inst::CG;
+  if(name == ".cs")
+    return ir::io_inst::CS;
+  if(is_load && name == ".ca")
+    return ir::io_inst::CA;
+  if(is_load && name == ".lu")
+    return ir::io_inst::LU;
+  if(!is_load && name == ".wb")
+    return ir::io_inst::WB;
+  if(!is_load && name == ".wt")
+    return ir::io_inst::WT;
+  throw semantic_error("Cache modifier " + name + " not supported for " + (is_load ? "loads" : "stores"));
+}
+
+ir::io_inst::EVICTION_POLICY eviction_policy(const std::string& name) {
+  if(name.empty())
+    return ir::io_inst::NORMAL;
+  if(name == "evict_first")
+    return ir::io_inst::EVICT_FIRST;
+  if(name == "evict_last")
+    return ir::io_inst::EVICT_LAST;
+  throw semantic_error("Eviction policy " + name + " not supported");
+}
+
+ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other,
+                          const std::string &cache, const std::string &eviction, ir::builder* builder) {
   if(!ptr->get_type()->get_scalar_ty()->is_pointer_ty())
     throw semantic_error("Pointer argument of load instruction is " + ptr->get_type()->repr());
+  ir::io_inst::CACHE_MODIFIER modifier = cache_modifier(cache, true);
+  ir::io_inst::EVICTION_POLICY policy = eviction_policy(eviction);
   if(ptr->get_type()->is_block_ty()){
     if(mask){
       mask = dispatch::broadcast(mask, ptr->get_type()->get_block_shapes(), builder);
@@ -501,7 +537,7 @@ ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir:
     }
   }
   if (!mask && !other)
-    return builder->create_load(ptr);
+    return builder->create_load(ptr, modifier, policy);
   if (!mask)
     throw std::runtime_error("`other` cannot be provided without `mask`");
   ir::type *elt_ty = ptr->get_type()->get_scalar_ty()->get_pointer_element_ty();
@@ -511,12 +547,15 @@ ir::value *dispatch::load(ir::value* ptr, ir::value* mask, ir::value* other, ir:
     if(ptr->get_type()->is_block_ty())
       other = builder->create_splat(other, ptr->get_type()->get_block_shapes());
   }
-  return builder->create_masked_load(ptr, mask, other);
+  return builder->create_masked_load(ptr, mask, other, modifier, policy);
 }
 
-ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask, ir::builder *builder) {
+ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask,
+                           const std::string &cache, const std::string &eviction, ir::builder *builder) {
   if(!ptr->get_type()->get_scalar_ty()->is_pointer_ty())
     throw semantic_error("Pointer argument of store instruction is " + ptr->get_type()->repr());
+  ir::io_inst::CACHE_MODIFIER modifier = cache_modifier(cache, false);
+  ir::io_inst::EVICTION_POLICY policy = eviction_policy(eviction);
   if(ptr->get_type()->is_block_ty())
     val = dispatch::broadcast(val, ptr->get_type()->get_block_shapes(), builder);
   if(mask)
@@ -524,10 +563,10 @@ ir::value *dispatch::store(ir::value* ptr, ir::value *val, ir::value* mask, ir::
   ir::type *ptr_ty = ptr->get_type();
   val = dispatch::cast(val, ptr_ty->get_scalar_ty()->get_pointer_element_ty(), builder);
   if (!mask)
-    return builder->create_store(ptr, val);
+    return builder->create_store(ptr, val, modifier, policy);
   if(!mask->get_type()->get_scalar_ty()->is_bool_ty())
     throw semantic_error("Mask must have boolean scalar type");
-  return builder->create_masked_store(ptr, val, mask);
+  return builder->create_masked_store(ptr, val, mask, modifier, policy);
 }
 
 ir::value *dispatch::atomic_cas(ir::value* ptr, ir::value *cmp, ir::value *val, ir::builder *builder){
@@ -619,12 +658,18 @@ ir::value *dispatch::atomic_xor(ir::value* ptr, ir::value *val, ir::value *mask,
 //                               Linear Algebra
 //===----------------------------------------------------------------------===//
 
-ir::value *dispatch::dot(ir::value *lhs, ir::value *rhs, ir::builder *builder) {
-  ir::value *_0 = builder->get_float32(0);
+ir::value *dispatch::dot(ir::value *lhs, ir::value *rhs, bool allow_tf32, ir::builder *builder) {
+  ir::type *lhs_sca_ty = lhs->get_type()->get_scalar_ty();
+  ir::type *rhs_sca_ty = rhs->get_type()->get_scalar_ty();
+  if(lhs_sca_ty->is_integer_ty() != rhs_sca_ty->is_integer_ty())
+    throw_incompatible_types(lhs_sca_ty, rhs_sca_ty);
+  // integer products are accumulated in int32
+  ir::value *_0 = lhs_sca_ty->is_integer_ty() ? (ir::value*)builder->get_int32(0)
+                                              : (ir::value*)builder->get_float32(0);
   unsigned M = lhs->get_type()->get_block_shapes()[0];
   unsigned N = rhs->get_type()->get_block_shapes()[1];
   _0 = builder->create_splat(_0, {M, N});
-  return builder->create_dot(lhs, rhs, _0);
+  return builder->create_dot(lhs, rhs, _0, allow_tf32);
 }
 
 
@@ -675,6 +720,45 @@ ir::value *dispatch::sum(ir::value *input, unsigned int axis, ir::builder *build
   return reduce_impl(input, axis, builder, "sum", ir::reduce_inst::FADD, ir::reduce_inst::ADD);
 }
 
+ir::value *dispatch::argmin(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return reduce_impl(input, axis, builder, "argmin", ir::reduce_inst::ARGFMIN, ir::reduce_inst::ARGMIN);
+}
+
+ir::value *dispatch::argmax(ir::value *input, unsigned int axis, ir::builder *builder) {
+  return reduce_impl(input, axis, builder, "argmax", ir::reduce_inst::ARGFMAX, ir::reduce_inst::ARGMAX);
+}
+
+//===----------------------------------------------------------------------===//
+//                               Scan
+//===----------------------------------------------------------------------===//
+
+ir::value *scan_impl(ir::value *input, unsigned int axis, bool exclusive, ir::builder *builder, const std::string &name,
+                     ir::scan_inst::op_t FLOAT_OP, ir::scan_inst::op_t INT_OP) {
+  if(!input->get_type()->is_block_ty() || axis >= input->get_type()->get_tile_rank())
+    throw semantic_error(name + ": invalid axis " + std::to_string(axis));
+  ir::type *scalar_ty = input->get_type()->get_scalar_ty();
+  // same promotion as reductions
+  if(scalar_ty->is_integer_ty() && scalar_ty->get_integer_bitwidth() <= 32)
+    input = dispatch::cast(input, type::get_int32_ty(scalar_ty->get_context()), builder);
+  if (scalar_ty->is_floating_point_ty())
+    return builder->create_scan(input, FLOAT_OP, axis, exclusive);
+  else if (scalar_ty->is_integer_ty())
+    return builder->create_scan(input, INT_OP, axis, exclusive);
+  return throw_unreachable(name);
+}
+
+ir::value *dispatch::cumsum(ir::value *input, unsigned int axis, bool exclusive, ir::builder *builder) {
+  return scan_impl(input, axis, exclusive, builder, "cumsum", ir::scan_inst::FADD, ir::scan_inst::ADD);
+}
+
+ir::value *dispatch::cummax(ir::value *input, unsigned int axis, bool exclusive, ir::builder *builder) {
+  return scan_impl(input, axis, exclusive, builder, "cummax", ir::scan_inst::FMAX, ir::scan_inst::MAX);
+}
+
+ir::value *dispatch::cummin(ir::value *input, unsigned int axis, bool exclusive, ir::builder *builder) {
+  return scan_impl(input, axis, exclusive, builder, "cummin", ir::scan_inst::FMIN, ir::scan_inst::MIN);
+}
+
 
 //===----------------------------------------------------------------------===//
 //                               Math
@@ -700,6 +784,44 @@ ir::value *dispatch::sqrt(ir::value *x, ir::builder *builder) {
   return builder->create_sqrt(x);
 }
 
+// transcendental functions are evaluated in fp32: integers are
+// promoted and fp64 is rejected rather than silently truncated
+ir::value *math_operand(ir::value *x, const std::string &name, ir::builder *builder) {
+  ir::type *sca_ty = x->get_type()->get_scalar_ty();
+  if(sca_ty->is_integer_ty())
+    return dispatch::cast(x, builder->get_float_ty(), builder);
+  if(sca_ty->is_fp16_ty() || sca_ty->is_bf16_ty() || sca_ty->is_fp32_ty())
+    return x;
+  throw semantic_error(name + " is only supported for float16, bfloat16 and float32 (got " + sca_ty->repr() + ")");
+}
+
+ir::value *dispatch::exp2(ir::value *x, bool approx, ir::builder *builder) {
+  return builder->create_exp2(math_operand(x, "exp2", builder), approx);
+}
+
+ir::value *dispatch::tanh(ir::value *x, bool approx, ir::builder *builder) {
+  return builder->create_tanh(math_operand(x, "tanh", builder), approx);
+}
+
+ir::value *dispatch::erf(ir::value *x, bool approx, ir::builder *builder) {
+  return builder->create_erf(math_operand(x, "erf", builder), approx);
+}
+
+ir::value *dispatch::sigmoid(ir::value *x, bool approx, ir::builder *builder) {
+  return builder->create_sigmoid(math_operand(x, "sigmoid", builder), approx);
+}
+
+ir::value *dispatch::rsqrt(ir::value *x, bool approx, ir::builder *builder) {
+  return builder->create_rsqrt(math_operand(x, "rsqrt", builder), approx);
+}
+
+ir::value *dispatch::pow(ir::value *x, ir::value *y, bool approx, ir::builder *builder) {
+  binary_op_type_checking(x, y, builder);
+  x = math_operand(x, "pow", builder);
+  y = math_operand(y, "pow", builder);
+  return builder->create_pow(x, y, approx);
+}
+
 
 //
 
@@ -54,6 +54,12 @@ void function::insert_block(basic_block *block, basic_block *next) {
   blocks_.insert(it, block);
 }
 
+void function::erase_block(basic_block *block) {
+  auto it = std::find(blocks_.begin(), blocks_.end(), block);
+  if(it != blocks_.end())
+    blocks_.erase(it);
+}
+
 
 function *function::create(function_type *ty, linkage_types_t linkage,
                            const std::string &name, module *mod) {
@@ -429,7 +429,7 @@ getelementptr_inst *getelementptr_inst::create(value *ptr, const std::vector<val
 
 // io_inst
 io_inst::io_inst(type *ty, value_id_t id, unsigned num_ops, const std::string &name, instruction *next)
-  : instruction(ty, id, num_ops, name, next)
+  : instruction(ty, id, num_ops, name, next), cache_modifier_(NONE), eviction_policy_(NORMAL)
 { }
 
 // load_inst
@@ -663,16 +663,22 @@ std::string reduce_inst::to_str(op_t op) {
     case FSUB: return "-";
     case FMAX: return "fmax";
     case FMIN: return "fmin";
+    case ARGMAX: return "argimax";
+    case ARGMIN: return "argimin";
+    case ARGFMAX: return "argfmax";
+    case ARGFMIN: return "argfmin";
     default: break;
   }
   assert(false);
   return "";
 }
 
-type* reduce_inst::get_res_type(value *arg, unsigned axis) {
+type* reduce_inst::get_res_type(value *arg, op_t op, unsigned axis) {
   ir::block_type::block_shapes_t shapes = arg->get_type()->get_block_shapes();
   shapes.erase(shapes.begin() + axis);
   type *scalar_ty = arg->get_type()->get_scalar_ty();
+  if(op == ARGMAX || op == ARGMIN || op == ARGFMAX || op == ARGFMIN)
+    scalar_ty = type::get_int32_ty(scalar_ty->get_context());
   if(shapes.empty())
 //    shapes.push_back(1);
     return scalar_ty;
@@ -680,7 +686,7 @@ type* reduce_inst::get_res_type(value *arg, unsigned axis) {
 }
 
 reduce_inst::reduce_inst(value *arg, op_t op, unsigned axis, const std::string &name, instruction *next)
-  : builtin_inst(get_res_type(arg, axis), INST_REDUCE, 1, name, next),
+  : builtin_inst(get_res_type(arg, op, axis), INST_REDUCE, 1, name, next),
     op_(op),
     axis_(axis){
   set_operand(0, arg);
@@ -690,6 +696,22 @@ instruction* reduce_inst::create(value *arg, op_t op, unsigned axis, const std::
   return new reduce_inst(arg, op, axis, name, next);
 }
 
+//===----------------------------------------------------------------------===//
+//                               scan instructions
+//===----------------------------------------------------------------------===//
+
+scan_inst::scan_inst(value *arg, op_t op, unsigned axis, bool exclusive, const std::string &name, instruction *next)
+  : builtin_inst(arg->get_type(), INST_SCAN, 1, name, next),
+    axis_(axis),
+    op_(op),
+    exclusive_(exclusive){
+  set_operand(0, arg);
+}
+
+instruction* scan_inst::create(value *arg, op_t op, unsigned axis, bool exclusive, const std::string &name, instruction *next) {
+  return new scan_inst(arg, op, axis, exclusive, name, next);
+}
+
 
 //===----------------------------------------------------------------------===//
 //                               select instructions
@@ -813,6 +835,73 @@ instruction* log_inst::create(value *val, const std::string& name, instruction *
   return new log_inst(val, name, next);
 }
 
+// exp2
+
+exp2_inst::exp2_inst(value *val, bool approx, const std::string &name, instruction *next)
+  : math_inst(val->get_type(), INST_EXP2, 1, approx, name, next) {
+  set_operand(0, val);
+}
+
+instruction* exp2_inst::create(value *val, bool approx, const std::string& name, instruction *next) {
+  return new exp2_inst(val, approx, name, next);
+}
+
+// tanh
+
+tanh_inst::tanh_inst(value *val, bool approx, const std::string &name, instruction *next)
+  : math_inst(val->get_type(), INST_TANH, 1, approx, name, next) {
+  set_operand(0, val);
+}
+
+instruction* tanh_inst::create(value *val, bool approx, const std::string& name, instruction *next) {
+  return new tanh_inst(val, approx, name, next);
+}
+
+// erf
+
+erf_inst::erf_inst(value *val, bool approx, const std::string &name, instruction *next)
+  : math_inst(val->get_type(), INST_ERF, 1, approx, name, next) {
+  set_operand(0, val);
+}
+
+instruction* erf_inst::create(value *val, bool approx, const std::string& name, instruction *next) {
+  return new erf_inst(val, approx, name, next);
+}
+
+// sigmoid
+
+sigmoid_inst::sigmoid_inst(value *val, bool approx, const std::string &name, instruction *next)
+  : math_inst(val->get_type(), INST_SIGMOID, 1, approx, name, next) {
+  set_operand(0, val);
+}
+
+instruction* sigmoid_inst::create(value *val, bool approx, const std::string& name, instruction *next) {
+  return new sigmoid_inst(val, approx, name, next);
+}
+
+// rsqrt
+
+rsqrt_inst::rsqrt_inst(value *val, bool approx, const std::string &name, instruction *next)
+  : math_inst(val->get_type(), INST_RSQRT, 1, approx, name, next) {
+  set_operand(0, val);
+}
+
+instruction* rsqrt_inst::create(value *val, bool approx, const std::string& name, instruction *next) {
+  return new rsqrt_inst(val, approx, name, next);
+}
+
+// pow
+
+pow_inst::pow_inst(value *x, value *y, bool approx, const std::string &name, instruction *next)
+  : math_inst(x->get_type(), INST_POW, 2, approx, name, next) {
+  set_operand(0, x);
+  set_operand(1, y);
+}
+
+instruction* pow_inst::create(value *x, value *y, bool approx, const std::string& name, instruction *next) {
+  return new pow_inst(x, y, approx, name, next);
+}
+
 
 //===----------------------------------------------------------------------===//
 //                               intrinsic instructions
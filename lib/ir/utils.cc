@@ -43,6 +43,57 @@ std::vector<basic_block*> cfg::reverse_post_order(function* fn) {
   return result;
 }
 
+std::map<basic_block*, basic_block*> cfg::immediate_post_dominators(function* fn) {
+  // post-order of the reverse CFG, rooted at a virtual exit
+  // node that succeeds every block without successors
+  std::vector<basic_block*> order;
+  std::map<basic_block*, int> index;
+  std::set<basic_block*> visited;
+  std::function<void(basic_block*)> dfs = [&](basic_block* block) {
+    for(basic_block* pred: block->get_predecessors())
+      if(visited.insert(pred).second)
+        dfs(pred);
+    index[block] = order.size();
+    order.push_back(block);
+  };
+  for(basic_block* block: fn->blocks())
+    if(block->get_successors().empty() && visited.insert(block).second)
+      dfs(block);
+  int exit = order.size();
+  // Cooper, Harvey & Kennedy -- "A Simple, Fast Dominance Algorithm"
+  std::vector<int> ipdom(exit + 1, -1);
+  ipdom[exit] = exit;
+  auto intersect = [&](int a, int b) {
+    while(a != b){
+      while(a < b) a = ipdom[a];
+      while(b < a) b = ipdom[b];
+    }
+    return a;
+  };
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(int n = exit - 1; n >= 0; n--){
+      basic_block* block = order[n];
+      int new_ipdom = block->get_successors().empty() ? exit : -1;
+      for(basic_block* succ: block->get_successors()){
+        auto it = index.find(succ);
+        if(it == index.end() || ipdom[it->second] == -1)
+          continue;
+        new_ipdom = new_ipdom == -1 ? it->second : intersect(it->second, new_ipdom);
+      }
+      if(new_ipdom != ipdom[n]){
+        ipdom[n] = new_ipdom;
+        changed = true;
+      }
+    }
+  }
+  std::map<basic_block*, basic_block*> result;
+  for(int n = 0; n < exit; n++)
+    result[order[n]] = ipdom[n] == exit ? nullptr : order[ipdom[n]];
+  return result;
+}
+
 void for_each_instruction(module &mod, const std::function<void (instruction *)> &do_work) {
   for(ir::function *fn: mod.get_function_list())
   for(ir::basic_block *block: cfg::reverse_post_order(fn))
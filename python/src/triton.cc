@@ -78,14 +78,14 @@ void init_triton_driver(py::module &&m) {
 
 void init_triton_codegen(py::module &&m) {
   m.def(
-      "add_passes_to_emit_bin", [](ir::module &ir, drv::device *dev, int num_warps, int num_stages, bool force_nc_cache) {
+      "add_passes_to_emit_bin", [](ir::module &ir, drv::device *dev, int num_warps, int num_stages, bool force_nc_cache, int unroll_max_size) {
         drv::module *mod;
         drv::kernel *ker;
         size_t shared_mem;
-        triton::codegen::add_passes_to_emit_bin(ir, dev, num_warps, num_stages, force_nc_cache, mod, ker, shared_mem);
+        triton::codegen::report_t report = triton::codegen::add_passes_to_emit_bin(ir, dev, num_warps, num_stages, force_nc_cache, unroll_max_size, mod, ker, shared_mem);
         std::stringstream ss;
         ir::print(ir, ss);
-        return std::make_tuple(mod, ker, shared_mem, ss.str());
+        return std::make_tuple(mod, ker, shared_mem, ss.str(), report);
       },
       py::return_value_policy::take_ownership);
 }
@@ -153,12 +153,24 @@ void init_triton_frontend(py::module &&m) {
   m.def("min", &ir::dispatch::min, ret::reference);
   m.def("max", &ir::dispatch::max, ret::reference);
   m.def("sum", &ir::dispatch::sum, ret::reference);
+  m.def("argmin", &ir::dispatch::argmin, ret::reference);
+  m.def("argmax", &ir::dispatch::argmax, ret::reference);
+  // scan
+  m.def("cumsum", &ir::dispatch::cumsum, ret::reference);
+  m.def("cummax", &ir::dispatch::cummax, ret::reference);
+  m.def("cummin", &ir::dispatch::cummin, ret::reference);
   // math
   m.def("exp", &ir::dispatch::exp, ret::reference);
   m.def("log", &ir::dispatch::log, ret::reference);
   m.def("cos", &ir::dispatch::cos, ret::reference);
   m.def("sin", &ir::dispatch::sin, ret::reference);
   m.def("sqrt", &ir::dispatch::sqrt, ret::reference);
+  m.def("exp2", &ir::dispatch::exp2, ret::reference);
+  m.def("tanh", &ir::dispatch::tanh, ret::reference);
+  m.def("erf", &ir::dispatch::erf, ret::reference);
+  m.def("sigmoid", &ir::dispatch::sigmoid, ret::reference);
+  m.def("rsqrt", &ir::dispatch::rsqrt, ret::reference);
+  m.def("pow", &ir::dispatch::pow, ret::reference);
   // internal (debugging only)
   m.def("multiple_of", &ir::dispatch::multiple_of, ret::reference);
   m.def("debug_barrier", &ir::dispatch::debug_barrier, ret::reference);
@@ -188,7 +200,8 @@ void init_triton_ir(py::module &&m) {
 
   py::class_<ir::constant_int, ir::constant>(m, "constant_int")
       .def_property_readonly("value", &ir::constant_int::get_value)
-      .def("__int__", [](ir::constant_int *self) { return self->get_value(); });
+      .def("__int__", [](ir::constant_int *self) { return self->get_value(); })
+      .def("__bool__", [](ir::constant_int *self) { return self->get_value() != 0; });
 
   py::class_<ir::constant_fp, ir::constant>(m, "constant_float")
       .def_property_readonly("value", &ir::constant_fp::get_value);
@@ -273,7 +286,8 @@ void init_triton_ir(py::module &&m) {
   py::class_<ir::argument, ir::value>(m, "argument");
 
   py::class_<ir::basic_block, ir::value>(m, "basic_block")
-      .def("create", &ir::basic_block::create, ret::reference)
+      .def("create", &ir::basic_block::create, ret::reference,
+           py::arg("context"), py::arg("name"), py::arg("parent"), py::arg("next") = nullptr)
       .def_property_readonly("parent", &ir::basic_block::get_parent, ret::reference);
 
   py::class_<ir::builder>(m, "builder", py::dynamic_attr())
@@ -150,6 +150,47 @@ def test_math_op(expr, device='cuda'):
     _test_unary('float32', f'tl.{expr}(x)', f'torch.{expr}(x) ', device=device)
 
 
+# error bounds documented in `triton.language`: ulps for the accurate
+# tier, relative error for the approximate tier
+@pytest.mark.parametrize("fn, x_range, y_range, max_ulp, max_rel", [
+    ('exp2', (-120, 120), None, 1, '2**-22'),
+    ('tanh', (-10, 10), None, 2, '2**-21'),
+    ('erf', (-5, 5), None, 2, '2**-22'),
+    ('sigmoid', (-80, 80), None, 3, '2**-21 * (1 + x.abs())'),
+    ('rsqrt', (1e-6, 1e6), None, 2, '2**-22'),
+    ('pow', (1e-2, 1e2), (-16, 16), 2, '2**-21 * (1 + y.abs() + (y * torch.log2(x)).abs())'),
+])
+@pytest.mark.parametrize("approx", [False, True])
+def test_math_accuracy(fn, x_range, y_range, max_ulp, max_rel, approx, device='cuda'):
+    SIZE = 4096
+    args = 'x, y' if y_range else 'x'
+
+    @triton.jit
+    def kernel(Z, X, Y, **meta):
+        off = tl.program_id(0) * meta['BLOCK'] + tl.arange(0, meta['BLOCK'])
+        x = tl.load(X + off)
+        y = tl.load(Y + off)
+        z = GENERATE_TEST_HERE
+        tl.store(Z + off, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{fn}({args}, approx={approx})'})
+    x = torch.empty(SIZE, dtype=torch.float32, device=device).uniform_(*x_range)
+    y = torch.empty(SIZE, dtype=torch.float32, device=device).uniform_(*(y_range or (0, 1)))
+    z_tri = torch.empty_like(x)
+    binary = kernel[(SIZE // 1024, )](z_tri, x, y, BLOCK=1024)
+    assert ('approx' in binary.asm('ptx')) == approx
+    # reference computed in float64 on the host
+    x, y = x.cpu().double(), y.cpu().double()
+    z_ref = eval(f'torch.{fn}({args})')
+    err = (z_tri.cpu().double() - z_ref).abs()
+    if approx:
+        assert (err / z_ref.abs() <= eval(max_rel)).all()
+    else:
+        ulp = z_ref.float().abs()
+        ulp = torch.nextafter(ulp, torch.full_like(ulp, float('inf'))) - ulp
+        assert (err / ulp.double()).max().item() <= max_ulp
+
+
 # ----------------
 # test indexing
 # ----------------
@@ -303,6 +344,43 @@ def test_atomic_rmw(op, dtype_x, mode, device='cuda'):
         triton.testing.assert_allclose(z_ref, z_tri)
 
 
+@pytest.mark.parametrize("op, dtype_x, axis", [
+    (op, dtype_x, axis) for op in ['add', 'max', 'min'] \
+                        for dtype_x in ['int32', 'float32'] \
+                        for axis in [0, 1]
+])
+def test_atomic_rmw_broadcast(op, dtype_x, axis, device='cuda'):
+    dtype_x = cvt[dtype_x]
+    M, N = 32, 32
+
+    # every row (axis=0) or column (axis=1) targets the same addresses
+    @triton.jit
+    def kernel(X, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        x = tl.load(X + rm[:, None] * meta['N'] + rn[None, :])
+        zero = tl.zeros([meta['M'], meta['N']], dtype=tl.int32)
+        if meta['AXIS'] == 0:
+            off = zero + rn[None, :]
+        else:
+            off = zero + rm[:, None]
+        GENERATE_TEST_HERE
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.atomic_{op}(Z + off, x)'})
+    max_neutral = float('-inf') if dtype_x.is_floating_point else torch.iinfo(dtype_x).min
+    min_neutral = float('inf') if dtype_x.is_floating_point else torch.iinfo(dtype_x).max
+    neutral = {'add': 0, 'max': max_neutral, 'min': min_neutral}[op]
+    x = torch.randint(-64, 64, (M, N), device=device).to(dtype_x)
+    z = torch.full((N if axis == 0 else M, ), neutral, dtype=dtype_x, device=device)
+    binary = kernel[(1, )](x, z, M=M, N=N, AXIS=axis, num_warps=4)
+    z_ref = {'add': lambda: x.sum(axis), 'max': lambda: x.max(axis)[0], 'min': lambda: x.min(axis)[0]}[op]()
+    assert torch.equal(z_ref.to(dtype_x), z)
+    # elements with the same address are combined before the atomic
+    per_thread = M * N // (4 * 32)
+    num_atomics = 2 if dtype_x.is_floating_point and op != 'add' else 1
+    assert binary.asm('ptx').count('atom.global') < per_thread * num_atomics
+
+
 # ---------------
 # test cast
 # ---------------
@@ -338,17 +416,1002 @@ def test_cast(dtype_x, dtype_z, bitcast, device='cuda'):
     assert z_tri == z_ref
 
 
+@pytest.mark.parametrize("dtype_str, expr", [
+    (dtype_str, expr) for dtype_str in ['float16', 'bfloat16'] \
+                      for expr in ['x + y', 'x - y', 'x * y', 'x * y + x']
+])
+def test_packed_x2(dtype_str, expr, device='cuda'):
+    SIZE = 1024
+    dtype = cvt[dtype_str]
+    capability = torch.cuda.get_device_capability(device)
+    if dtype == torch.bfloat16 and capability[0] < 8:
+        pytest.skip("bf16x2 arithmetic requires sm80")
+
+    @triton.jit
+    def kernel(Z, X, Y, **meta):
+        off = tl.arange(0, meta['SIZE'])
+        x = tl.load(X + off)
+        y = tl.load(Y + off)
+        z = GENERATE_TEST_HERE
+        tl.store(Z + off, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': expr})
+    x = triton.testing.random(SIZE, dtype=torch.float32, device=device).to(dtype)
+    y = triton.testing.random(SIZE, dtype=torch.float32, device=device).to(dtype)
+    z_ref = eval(expr)
+    z_tri = torch.empty_like(z_ref)
+    binary = kernel[(1, )](z_tri, x, y, SIZE=SIZE, num_warps=4)
+    triton.testing.assert_allclose(z_ref.float(), z_tri.float())
+    # adjacent elements are processed two at a time
+    ptx = binary.asm('ptx')
+    assert ('f16x2' if dtype == torch.float16 else 'bf16x2') in ptx
+
+
+def test_transpose_layout(device='cuda'):
+    M, N = 64, 64
+
+    @triton.jit
+    def kernel(X, Z1, Z2, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        x = tl.load(X + rm[:, None] * meta['N'] + rn[None, :])
+        tl.store(Z1 + rm[:, None] + rn[None, :] * meta['M'], x)
+        tl.store(Z2 + rm[:, None] + rn[None, :] * meta['M'], x * 2)
+
+    x = torch.randn((M, N), dtype=torch.float32, device=device)
+    z1 = torch.empty((N, M), dtype=torch.float32, device=device)
+    z2 = torch.empty((N, M), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z1, z2, M=M, N=N)
+    triton.testing.assert_allclose(x.t(), z1)
+    triton.testing.assert_allclose(2 * x.t(), z2)
+    # the tile is laid out along the columns, as both stores are, and only
+    # the load goes through shared memory, instead of both stores
+    assert binary.report['coalesce.conversions'] == 1
+    assert binary.report['coalesce.avoided_conversions'] == 1
+
+
+@pytest.mark.parametrize("offset", [0, 1])
+def test_alignment_variants(offset, device='cuda'):
+    N = 512
+
+    @triton.jit
+    def kernel(X, Y, ZX, ZY, **meta):
+        off_x = tl.arange(0, meta['N'])
+        tl.store(ZX + off_x, tl.load(X + off_x))
+        off_y = tl.arange(0, meta['N'])
+        tl.store(ZY + off_y, tl.load(Y + off_y))
+
+    x = torch.randn(N, dtype=torch.float32, device=device)
+    y = torch.randn(N + 1, dtype=torch.float32, device=device)[offset:offset + N]
+    zx = torch.empty(N, dtype=torch.float32, device=device)
+    zy = torch.empty(N, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, zx, zy, N=N)
+    assert torch.equal(x, zx) and torch.equal(y, zy)
+    loads = [line for line in binary.asm('ptx').split('\n') if 'ld.global' in line]
+    # a misaligned `Y` does not prevent `X` from being loaded with .v4
+    num_vec = sum('.v4' in line for line in loads)
+    assert num_vec == (2 if offset == 0 else 1)
+    assert (num_vec < len(loads)) == (offset != 0)
+
+
+def test_alignment_variants_launch(device='cuda'):
+    M, N = 64, 64
+
+    @triton.jit
+    def kernel(X, Z, stride, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        off = rm[:, None] * stride + rn[None, :]
+        tl.store(Z + off, tl.load(X + off))
+
+    # int8 rows are loaded 16, 8 and 4 bytes at a time
+    widths = {64: '.v4.b32', 72: '.v2.b32', 68: '.b32'}
+    for stride, width in widths.items():
+        x = torch.randint(-128, 127, (M, stride), dtype=torch.int8, device=device)
+        z = torch.zeros((M, stride), dtype=torch.int8, device=device)
+        binary = kernel[(1, )](x, z, stride, M=M, N=N)
+        assert torch.equal(x[:, :N], z[:, :N])
+        loads = [line for line in binary.asm('ptx').split('\n') if 'ld.global' in line]
+        assert loads and all(f'ld.global.cg{width}' in line for line in loads)
+    # all the variants come from a single entry of the cache
+    assert len(kernel.cache) == 1
+
+
+def test_select_vectorized(device='cuda'):
+    N, BLOCK = 96, 128
+
+    @triton.jit
+    def kernel(X, Y, Z, N, **meta):
+        rn = tl.arange(0, meta['BLOCK'])
+        # the mask only changes at multiples of 16, so the selected
+        # pointers stay contiguous and aligned
+        ptrs = tl.where(rn < N, X + rn, Y + rn)
+        tl.store(Z + rn, tl.load(ptrs))
+
+    x = torch.randn(BLOCK, dtype=torch.float32, device=device)
+    y = torch.randn(BLOCK, dtype=torch.float32, device=device)
+    z = torch.empty(BLOCK, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, z, N, BLOCK=BLOCK)
+    rn = torch.arange(BLOCK, device=device)
+    triton.testing.assert_allclose(torch.where(rn < N, x, y), z)
+    ptx = binary.asm('ptx')
+    assert any('ld.global' in line and '.v4' in line for line in ptx.split('\n'))
+    assert binary.report['isel.align_limited_accesses'] == 0
+
+
+def test_modulo_vectorized(device='cuda'):
+    N, BLOCK, off = 256, 128, 192
+
+    @triton.jit
+    def kernel(X, Z, off, N, **meta):
+        rn = tl.arange(0, meta['BLOCK'])
+        # wraps around at N, which is a multiple of 16 as `off` is
+        tl.store(Z + rn, tl.load(X + (rn + off) % N))
+
+    x = torch.randn(N, dtype=torch.float32, device=device)
+    z = torch.empty(BLOCK, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z, off, N, BLOCK=BLOCK)
+    rn = torch.arange(BLOCK, device=device)
+    assert torch.equal(x[(rn + off) % N], z)
+    ptx = binary.asm('ptx')
+    assert any('ld.global' in line and '.v4' in line for line in ptx.split('\n'))
+    assert binary.report['isel.align_limited_accesses'] == 0
+
+
+def test_loop_pointer_vectorized(device='cuda'):
+    K, BLOCK = 16, 128
+
+    @triton.jit
+    def kernel(X, Z, K, **meta):
+        rn = tl.arange(0, meta['BLOCK'])
+        ptrs = X + rn
+        acc = tl.zeros((meta['BLOCK'], ), dtype=tl.float32)
+        for k in range(0, K):
+            acc += tl.load(ptrs)
+            # stays aligned across iterations
+            ptrs += meta['BLOCK']
+        tl.store(Z + rn, acc)
+
+    x = torch.randn((K, BLOCK), dtype=torch.float32, device=device)
+    z = torch.empty(BLOCK, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z, K, BLOCK=BLOCK)
+    triton.testing.assert_allclose(x.sum(0), z)
+    ptx = binary.asm('ptx')
+    assert any('ld.global' in line and '.v4' in line for line in ptx.split('\n'))
+    assert binary.report['isel.align_limited_accesses'] == 0
+
+
+# ---------------
+# test dot
+# ---------------
+@pytest.mark.parametrize("trans_z, ldz_pad", [(trans_z, ldz_pad) for trans_z in [False, True] for ldz_pad in [0, 1]])
+def test_dot_epilogue(trans_z, ldz_pad, device='cuda'):
+    M, N, K = 64, 64, 32
+
+    @triton.jit
+    def kernel(X, Y, Z, stride_zm, stride_zn, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] * meta['N'] + rn[None, :])
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * stride_zm + rn[None, :] * stride_zn, z)
+
+    x = torch.randn((M, K), dtype=torch.float16, device=device)
+    y = torch.randn((K, N), dtype=torch.float16, device=device)
+    ldz = N + ldz_pad
+    z = torch.empty((M, ldz), dtype=torch.float32, device=device)
+    stride_zm, stride_zn = (1, ldz) if trans_z else (ldz, 1)
+    binary = kernel[(1, )](x, y, z, stride_zm, stride_zn, M=M, N=N, K=K)
+    z_ref = torch.matmul(x.float(), y.float())
+    z_tri = z[:, :M].t() if trans_z else z[:, :N]
+    triton.testing.assert_allclose(z_ref, z_tri)
+    # fp32 fragments are stored directly, two elements at a time along
+    # rows, and go through shared memory when written along columns
+    # (one element at a time) if the store can then be vectorized to 128 bits
+    aligned = ldz % 4 == 0
+    staged = trans_z and aligned
+    ptx = binary.asm('ptx')
+    assert binary.report['coalesce.staged_stores'] == int(staged)
+    assert ('st.global.v4' in ptx) == staged
+    assert ('st.global.v2' in ptx) == (not trans_z and aligned)
+    # the staging buffer reuses the memory of the (dead) operands
+    assert binary.report['allocation.allocated_bytes'] == binary.report['allocation.peak_live_bytes']
+
+
+@pytest.mark.parametrize("trans_a, trans_b", [(False, False), (True, False), (False, True), (True, True)])
+def test_dot_ldmatrix(trans_a, trans_b, device='cuda'):
+    if torch.cuda.get_device_capability(device) < (7, 5):
+        pytest.skip("ldmatrix requires sm75")
+    M, N, K = 64, 64, 64
+
+    @triton.jit
+    def kernel(X, stride_xm, stride_xk, Y, stride_yk, stride_yn, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * stride_xm + rk[None, :] * stride_xk)
+        y = tl.load(Y + rk[:, None] * stride_yk + rn[None, :] * stride_yn)
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z)
+
+    x = torch.randn((K, M) if trans_a else (M, K), dtype=torch.float16, device=device)
+    y = torch.randn((N, K) if trans_b else (K, N), dtype=torch.float16, device=device)
+    x = x.t() if trans_a else x
+    y = y.t() if trans_b else y
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, x.stride(0), x.stride(1), y, y.stride(0), y.stride(1), z, M=M, N=N, K=K)
+    triton.testing.assert_allclose(torch.matmul(x.float(), y.float()), z)
+    # operands whose layout does not match the mma fragments (column-major A,
+    # row-major B) are read with ldmatrix.trans, the others with ldmatrix
+    ptx = binary.asm('ptx')
+    assert ('ldmatrix.sync.aligned.m8n8.x4.trans.shared.b16' in ptx) == (trans_a or not trans_b)
+    assert ('ldmatrix.sync.aligned.m8n8.x4.shared.b16' in ptx) == (not trans_a or trans_b)
+    assert 'ld.shared.b16' not in ptx
+    # copies of x, y to shared memory and their reads by ldmatrix are conflict-free
+    assert binary.report['bank_conflicts.accesses'] == 3
+    assert binary.report['bank_conflicts.max_degree'] == 1
+
+
+@pytest.mark.parametrize("trans_b", [False, True])
+def test_dot_int8(trans_b, device='cuda'):
+    M, N, K = 64, 64, 64
+
+    @triton.jit
+    def kernel(X, Y, stride_yk, stride_yn, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] * stride_yk + rn[None, :] * stride_yn)
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z)
+
+    x = torch.randint(-128, 128, (M, K), dtype=torch.int8, device=device)
+    y = torch.randint(-128, 128, (N, K) if trans_b else (K, N), dtype=torch.int8, device=device)
+    y = y.t() if trans_b else y
+    z = torch.empty((M, N), dtype=torch.int32, device=device)
+    binary = kernel[(1, )](x, y, y.stride(0), y.stride(1), z, M=M, N=N, K=K)
+    z_ref = torch.matmul(x.cpu().long(), y.cpu().long()).int()
+    assert torch.equal(z.cpu(), z_ref)
+    # tensor cores need both operands to be contiguous along K
+    ptx = binary.asm('ptx')
+    use_mma = trans_b and torch.cuda.get_device_capability(device)[0] >= 8
+    assert ('mma.sync.aligned.m16n8k32.row.col.s32.s8.s8.s32' in ptx) == use_mma
+    assert ('dp4a.s32.s32' in ptx) == (not use_mma)
+
+
+@pytest.mark.parametrize("allow_tf32", [False, True])
+def test_dot_tf32(allow_tf32, device='cuda'):
+    M, N, K = 64, 64, 32
+
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] + rn[None, :] * meta['K'])
+        z = tl.dot(x, y, allow_tf32=meta['ALLOW_TF32'])
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z)
+
+    x = torch.randn((M, K), dtype=torch.float32, device=device)
+    y = torch.randn((N, K), dtype=torch.float32, device=device).t()
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, z, M=M, N=N, K=K, ALLOW_TF32=allow_tf32)
+    z_ref = torch.matmul(x.double(), y.double()).float()
+    triton.testing.assert_allclose(z_ref, z)
+    use_tf32 = allow_tf32 and torch.cuda.get_device_capability(device)[0] >= 8
+    ptx = binary.asm('ptx')
+    assert ('mma.sync.aligned.m16n8k8.row.col.f32.tf32.tf32.f32' in ptx) == use_tf32
+    assert ('cvt.rna.tf32.f32' in ptx) == use_tf32
+
+
+
+def test_dot_bank_conflicts(device='cuda'):
+    M, N, K = 64, 64, 4
+
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] * meta['N'] + rn[None, :])
+        z = tl.dot(x, y, allow_tf32=False)
+        tl.store(Z + rm[:, None] + rn[None, :] * meta['M'], z)
+
+    x = torch.randn((M, K), dtype=torch.float32, device=device)
+    y = torch.randn((K, N), dtype=torch.float32, device=device)
+    z = torch.empty((N, M), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, z, M=M, N=N, K=K, num_warps=4)
+    z_ref = torch.matmul(x.double(), y.double()).float()
+    triton.testing.assert_allclose(z_ref, z.t())
+    # the first warp reads x at rows 0, 4, ..., 60. Rows of x are 16 bytes
+    # wide and only hold two 8-byte chunks to swizzle, so rows 0, 16, 32
+    # and 48 still fall in the same bank. y is written with scalar stores
+    # two elements apart, so lanes l and l + 16 share a bank
+    assert binary.report['bank_conflicts.accesses'] == 3
+    assert binary.report['bank_conflicts.conflicting_accesses'] == 2
+    assert binary.report['bank_conflicts.max_degree'] == 4
+
+
+def test_swizzle_fma_dot(device='cuda'):
+    M, N, K = 16, 4, 16
+
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] * meta['N'] + rn[None, :])
+        z = tl.dot(x, y, allow_tf32=False)
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z)
+
+    x = torch.randn((M, K), dtype=torch.float32, device=device)
+    y = torch.randn((K, N), dtype=torch.float32, device=device)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, z, M=M, N=N, K=K, num_warps=2)
+    z_ref = torch.matmul(x.double(), y.double()).float()
+    triton.testing.assert_allclose(z_ref, z)
+    # the first warp reads column 0 of rows 0..7 of x, which is contiguous
+    # along K. Without swizzling, rows of 64 bytes put them in two banks
+    assert binary.report['bank_conflicts.accesses'] == 3
+    assert binary.report['bank_conflicts.max_degree'] == 1
+
+
+def test_swizzle_recoalesce(device='cuda'):
+    if torch.cuda.get_device_capability(device) < (7, 5):
+        pytest.skip("bank conflicts of recoalesce are only computed from sm75")
+    M, N, K = 64, 64, 64
+
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :])
+        y = tl.load(Y + rk[:, None] * meta['N'] + rn[None, :])
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z.to(tl.float16))
+
+    x = torch.randn((M, K), dtype=torch.float16, device=device)
+    y = torch.randn((K, N), dtype=torch.float16, device=device)
+    z = torch.empty((M, N), dtype=torch.float16, device=device)
+    binary = kernel[(1, )](x, y, z, M=M, N=N, K=K, num_warps=4)
+    triton.testing.assert_allclose(torch.matmul(x.float(), y.float()).half(), z)
+    # fp16 results go through shared memory. The mma fragments write 8
+    # contiguous elements of 8 rows of 128 bytes, which would all fall in
+    # the same 4 banks without swizzling
+    assert binary.report['bank_conflicts.accesses'] == 4
+    assert binary.report['bank_conflicts.max_degree'] == 1
+
+# ---------------
+# test reduce
+# ---------------
+@pytest.mark.parametrize("op, dtype_str, axis, shape", [
+    (op, dtype_str, axis, shape) \
+  for op in ['sum', 'max', 'min'] \
+  for dtype_str in ['float16', 'bfloat16', 'float32', 'float64', 'int32', 'int64'] \
+  for axis in [0, 1] \
+  for shape in [(1, 128), (4, 64), (32, 32), (128, 8)]
+])
+def test_reduce2d(op, dtype_str, axis, shape, device='cuda'):
+    M, N = shape
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        if meta['AXIS'] == 0:
+            tl.store(Z + range_n, z)
+        else:
+            tl.store(Z + range_m, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=meta["AXIS"])'})
+    dtype = cvt[dtype_str]
+    x = triton.testing.random((M, N), dtype=torch.float32 if dtype == torch.bfloat16 else dtype, device=device).to(dtype)
+    z_ref = getattr(torch, op)(x.to(torch.float64 if x.is_floating_point() else torch.int64), dim=axis)
+    if op != 'sum':
+        z_ref = z_ref.values
+    z_tri = torch.empty(z_ref.shape, dtype=x.dtype, device=device)
+    kernel[(1, )](x, z_tri, BLOCK_M=M, BLOCK_N=N, AXIS=axis)
+    if x.is_floating_point():
+        # bfloat16 sums are rounded after every addition
+        tol = 5e-2 if dtype == torch.bfloat16 else 1e-2
+        triton.testing.assert_allclose(z_ref.to(z_tri.dtype), z_tri, tol=tol)
+    else:
+        assert torch.equal(z_ref.to(z_tri.dtype), z_tri)
+
+
+@pytest.mark.parametrize("op, dtype_str, axis, shape", [
+    (op, dtype_str, axis, shape) \
+  for op in ['argmax', 'argmin'] \
+  for dtype_str in ['float16', 'bfloat16', 'float32', 'int32', 'int64'] \
+  for axis in [0, 1] \
+  for shape in [(1, 128), (32, 32), (128, 8), (4, 1024)]
+])
+def test_argreduce2d(op, dtype_str, axis, shape, device='cuda'):
+    M, N = shape
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        z = GENERATE_TEST_HERE
+        if meta['AXIS'] == 0:
+            tl.store(Z + range_n, z)
+        else:
+            tl.store(Z + range_m, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=meta["AXIS"])'})
+    # few distinct values, so that ties are frequent
+    x = torch.randint(-8, 8, (M, N), device=device).to(cvt[dtype_str])
+    # the host implementation returns the first extremum
+    z_ref = getattr(torch, op)(x.cpu().to(torch.float64), dim=axis).to(torch.int32)
+    z_tri = torch.empty(z_ref.shape, dtype=torch.int32, device=device)
+    kernel[(1, )](x, z_tri, BLOCK_M=M, BLOCK_N=N, AXIS=axis)
+    assert torch.equal(z_ref, z_tri.cpu())
+
+
+@pytest.mark.parametrize("dtype_str, axis, shape", [
+    (dtype_str, axis, shape) \
+  for dtype_str in ['float16', 'float32'] \
+  for axis in [0, 1] \
+  for shape in [(32, 32), (4, 1024)]
+])
+def test_fused_reduce2d(dtype_str, axis, shape, device='cuda'):
+    M, N = shape
+
+    @triton.jit
+    def kernel(X, S, Q, Z, I, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :]).to(tl.float32)
+        # independent reductions of the same tile share one pass
+        s = tl.sum(x, axis=meta['AXIS'])
+        q = tl.sum(x * x, axis=meta['AXIS'])
+        z = tl.max(x, axis=meta['AXIS'])
+        i = tl.argmax(x, axis=meta['AXIS'])
+        off = range_n if meta['AXIS'] == 0 else range_m
+        tl.store(S + off, s)
+        tl.store(Q + off, q)
+        tl.store(Z + off, z)
+        tl.store(I + off, i)
+
+    x = torch.randint(-8, 8, (M, N), device=device).to(cvt[dtype_str])
+    x_ref = x.cpu().to(torch.float64)
+    outs = [torch.empty(shape[1 - axis], dtype=torch.float32, device=device) for _ in range(3)]
+    idx = torch.empty(shape[1 - axis], dtype=torch.int32, device=device)
+    binary = kernel[(1, )](x, *outs, idx, BLOCK_M=M, BLOCK_N=N, AXIS=axis)
+    assert torch.equal(outs[0].cpu().to(torch.float64), x_ref.sum(axis))
+    assert torch.equal(outs[1].cpu().to(torch.float64), (x_ref * x_ref).sum(axis))
+    assert torch.equal(outs[2].cpu().to(torch.float64), x_ref.max(axis)[0])
+    assert torch.equal(idx.cpu(), x_ref.argmax(axis).to(torch.int32))
+    assert binary.report['layouts.fused_reductions'] == 3
+    assert binary.asm('llir').count('call void @llvm.nvvm.barrier0()') <= 1
+
+
+@pytest.mark.parametrize("axis", [0, 1])
+def test_reduce2d_shared_reuse(axis, device='cuda'):
+    M, N = 32, 32
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        z = tl.max(x, axis=meta['AXIS'])
+        off = range_n if meta['AXIS'] == 0 else range_m
+        tl.store(Z + off, z)
+
+    @triton.jit
+    def kernel_dependent(X, Z, S, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        z = tl.max(x, axis=meta['AXIS'])
+        y = x - (z[None, :] if meta['AXIS'] == 0 else z[:, None])
+        s = tl.sum(y, axis=meta['AXIS'])
+        off = range_n if meta['AXIS'] == 0 else range_m
+        tl.store(Z + off, z)
+        tl.store(S + off, s)
+
+    x = torch.randn((M, N), dtype=torch.float32, device=device)
+    z = torch.empty(M, dtype=torch.float32, device=device)
+    s = torch.empty(M, dtype=torch.float32, device=device)
+    ref = kernel[(1, )](x, z, BLOCK_M=M, BLOCK_N=N, AXIS=axis)
+    binary = kernel_dependent[(1, )](x, z, s, BLOCK_M=M, BLOCK_N=N, AXIS=axis)
+    z_ref = x.max(axis)[0]
+    triton.testing.assert_allclose(z_ref, z)
+    triton.testing.assert_allclose((x - z_ref.unsqueeze(axis)).sum(axis), s)
+    # the buffer of the first reduction is dead once it has been combined,
+    # even though its result is still live, and is reused by the second one
+    assert binary.report['allocation.allocated_bytes'] == ref.report['allocation.allocated_bytes']
+    # which only takes a barrier between the reads of the first reduction
+    # and the writes of the second one. Along axis 1, each row is held by
+    # a single warp and neither reduction goes through shared memory
+    assert (ref.report['allocation.allocated_bytes'] > 0) == (axis == 0)
+    assert binary.report['membar.barriers'] == (1 if axis == 0 else 0)
+    assert binary.report['membar.barriers'] <= binary.report['membar.inserted_barriers']
+
+
+def test_reduce2d_shared_reuse_branches(device='cuda'):
+    M, N = 32, 32
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        z = tl.max(x, axis=0)
+        tl.store(Z + range_n, z)
+
+    @triton.jit
+    def kernel_branches(X, Z, **meta):
+        pid = tl.program_id(0)
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        x = tl.load(X + range_m[:, None] * meta['BLOCK_N'] + range_n[None, :])
+        if pid == 0:
+            z = tl.max(x, axis=0)
+        else:
+            z = tl.sum(x, axis=0)
+        tl.store(Z + pid * meta['BLOCK_N'] + range_n, z)
+
+    x = torch.randn((M, N), dtype=torch.float32, device=device)
+    z = torch.empty((2, N), dtype=torch.float32, device=device)
+    ref = kernel[(1, )](x, z, BLOCK_M=M, BLOCK_N=N)
+    binary = kernel_branches[(2, )](x, z, BLOCK_M=M, BLOCK_N=N)
+    triton.testing.assert_allclose(x.max(0)[0], z[0])
+    triton.testing.assert_allclose(x.sum(0), z[1])
+    # the reductions of the two branches never live at the same time and
+    # share the same buffer
+    buffer_bytes = ref.report['allocation.allocated_bytes']
+    assert buffer_bytes > 0
+    assert binary.report['allocation.allocated_bytes'] == buffer_bytes
+
+
+def test_reduce2d_shared_reuse_loops(device='cuda'):
+    M, N, K = 32, 32, 4
+
+    @triton.jit
+    def kernel(X, Z, K, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None] * meta['BLOCK_N'] + range_n[None, :]
+        z = tl.zeros((meta['BLOCK_N'], ), dtype=tl.float32)
+        for k in range(0, K):
+            z += tl.max(tl.load(X + k * meta['BLOCK_M'] * meta['BLOCK_N'] + off), axis=0)
+        tl.store(Z + range_n, z)
+
+    @triton.jit
+    def kernel_two_loops(X, Z, S, K, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None] * meta['BLOCK_N'] + range_n[None, :]
+        z = tl.zeros((meta['BLOCK_N'], ), dtype=tl.float32)
+        for k in range(0, K):
+            z += tl.max(tl.load(X + k * meta['BLOCK_M'] * meta['BLOCK_N'] + off), axis=0)
+        s = tl.zeros((meta['BLOCK_N'], ), dtype=tl.float32)
+        for k in range(0, K):
+            s += tl.sum(tl.load(X + k * meta['BLOCK_M'] * meta['BLOCK_N'] + off), axis=0)
+        tl.store(Z + range_n, z)
+        tl.store(S + range_n, s)
+
+    @triton.jit
+    def kernel_dependent(X, S, K, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None] * meta['BLOCK_N'] + range_n[None, :]
+        s = tl.zeros((meta['BLOCK_N'], ), dtype=tl.float32)
+        for k in range(0, K):
+            x = tl.load(X + k * meta['BLOCK_M'] * meta['BLOCK_N'] + off)
+            z = tl.max(x, axis=0)
+            s += tl.sum(x - z[None, :], axis=0)
+        tl.store(S + range_n, s)
+
+    x = torch.randn((K, M, N), dtype=torch.float32, device=device)
+    z = torch.empty(N, dtype=torch.float32, device=device)
+    s = torch.empty(N, dtype=torch.float32, device=device)
+    z_ref = x.max(1)[0].sum(0)
+    ref = kernel[(1, )](x, z, K, BLOCK_M=M, BLOCK_N=N)
+    triton.testing.assert_allclose(z_ref, z)
+    buffer_bytes = ref.report['allocation.allocated_bytes']
+    assert buffer_bytes > 0
+    # the reductions of two loop nests alias
+    two_loops = kernel_two_loops[(1, )](x, z, s, K, BLOCK_M=M, BLOCK_N=N)
+    triton.testing.assert_allclose(z_ref, z)
+    triton.testing.assert_allclose(x.sum(1).sum(0), s)
+    assert two_loops.report['allocation.allocated_bytes'] == buffer_bytes
+    # the buffer of the first reduction is only live within each iteration,
+    # and not across the whole loop, so the second reduction reuses it
+    dependent = kernel_dependent[(1, )](x, s, K, BLOCK_M=M, BLOCK_N=N)
+    triton.testing.assert_allclose((x - x.max(1, keepdim=True)[0]).sum(1).sum(0), s)
+    assert dependent.report['allocation.allocated_bytes'] == buffer_bytes
+
+
+@pytest.mark.parametrize("num_stages", [2, 3])
+def test_reduce_pipelined(num_stages, device='cuda'):
+    M, N, BLOCK_N = 32, 512, 64
+
+    @triton.jit
+    def kernel(X, Z, N, **meta):
+        rm = tl.arange(0, meta['BLOCK_M'])
+        rn = tl.arange(0, meta['BLOCK_N'])
+        ptrs = X + rm[:, None] * N + rn[None, :]
+        acc = tl.zeros([meta['BLOCK_M']], dtype=tl.float32)
+        for k in range(0, N, meta['BLOCK_N']):
+            x = tl.load(ptrs)
+            # the loaded tile has several consumers, none of them a dot
+            acc += tl.sum(x * x, axis=1) + tl.max(x, axis=1)
+            ptrs += meta['BLOCK_N']
+        tl.store(Z + rm, acc)
+
+    x = torch.randn((M, N), dtype=torch.float32, device=device)
+    z = torch.empty(M, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z, N, BLOCK_M=M, BLOCK_N=BLOCK_N, num_stages=num_stages)
+    xb = x.view(M, N // BLOCK_N, BLOCK_N)
+    z_ref = ((xb * xb).sum(2) + xb.max(2)[0]).sum(1)
+    triton.testing.assert_allclose(z_ref, z)
+    assert binary.report['pipeline.pipelined_loads'] == 1
+    # loads are copied asynchronously to shared memory on sm80, and
+    # prefetched in registers otherwise
+    has_cp_async = torch.cuda.get_device_capability(device) >= (8, 0)
+    assert binary.report['pipeline.staged_loads'] == int(has_cp_async)
+    assert ('cp.async' in binary.asm('ptx')) == has_cp_async
+
+
+@pytest.mark.parametrize("N", [1024, 1000])
+def test_loop_versioning(N, device='cuda'):
+    BLOCK = 128
+
+    @triton.jit
+    def kernel(X, Z, N, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        for k in range(0, N, meta['BLOCK']):
+            mask = off < N - k
+            x = tl.load(X + k + off, mask=mask, other=0.)
+            tl.store(Z + k + off, x + 1, mask=mask)
+
+    x = torch.randn(N, dtype=torch.float32, device=device)
+    z = torch.empty(N, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z, N, BLOCK=BLOCK)
+    triton.testing.assert_allclose(x + 1, z)
+    assert binary.report['versioning.versioned_loops'] == 1
+    # the loop is split into an unmasked copy, used while full tiles
+    # remain, and the original masked loop for the remainder
+    fast_path, in_fast_path = [], False
+    for line in binary.asm('ttir').split('\n'):
+        if line and not line.startswith(' ') and ':' in line:
+            in_fast_path = line.split(':')[0].endswith('.unmasked')
+        elif in_fast_path:
+            fast_path.append(line.split('= ')[-1].strip())
+    assert any(i.startswith('unmasked_load') for i in fast_path)
+    assert any(i.startswith('unmasked_store') for i in fast_path)
+    assert not any(i.startswith(('masked_load', 'masked_store')) for i in fast_path)
+    loads = [line.strip() for line in binary.asm('ptx').split('\n') if 'ld.global' in line]
+    assert any(line.startswith('ld.global') for line in loads)
+    assert any(line.startswith('@') for line in loads)
+
+
+@pytest.mark.parametrize("unroll_max_size", [0, 128])
+def test_unroll(unroll_max_size, device='cuda'):
+    N, BLOCK = 4, 128
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['BLOCK'])
+        acc = tl.zeros((meta['BLOCK'], ), dtype=tl.float32)
+        for i in range(0, meta['N']):
+            acc += tl.load(X + i * meta['BLOCK'] + off)
+        tl.store(Z + off, acc)
+
+    x = torch.randn(N * BLOCK, dtype=torch.float32, device=device)
+    z = torch.empty(BLOCK, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, z, N=N, BLOCK=BLOCK, unroll_max_size=unroll_max_size)
+    triton.testing.assert_allclose(x.view(N, BLOCK).sum(0), z)
+    # with a zero budget the loop is kept as is
+    unrolled = unroll_max_size > 0
+    assert binary.report['unroll.unrolled_loops'] == int(unrolled)
+    loads = [line for line in binary.asm('ttir').split('\n') if 'unmasked_load' in line]
+    assert len(loads) == (N if unrolled else 1)
+
+
+@pytest.mark.parametrize("num_stages", [2, 3])
+def test_pipeline_read_after_write(num_stages, device='cuda'):
+    N, BLOCK = 1024, 128
+
+    @triton.jit
+    def kernel(X, N, **meta):
+        ptrs = X + tl.arange(0, meta['BLOCK'])
+        for k in range(0, N - meta['BLOCK'], meta['BLOCK']):
+            x = tl.load(ptrs)
+            # the next iteration reads what this one writes
+            tl.store(ptrs + meta['BLOCK'], x + 1)
+            ptrs += meta['BLOCK']
+
+    x = torch.zeros(N, dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, N, BLOCK=BLOCK, num_stages=num_stages)
+    ref = (torch.arange(N, device=device) // BLOCK).float()
+    triton.testing.assert_allclose(ref, x)
+    assert binary.report['pipeline.pipelined_loads'] == 0
+
+
+@pytest.mark.parametrize("op, dtype_str, axis, shape, exclusive", [
+    (op, dtype_str, axis, shape, exclusive) \
+  for op in ['cumsum', 'cummax', 'cummin'] \
+  for dtype_str in ['float32', 'int32'] \
+  for axis in [0, 1] \
+  for shape in [(1, 128), (32, 32), (4, 1024)] \
+  for exclusive in [False, True]
+])
+def test_scan2d(op, dtype_str, axis, shape, exclusive, device='cuda'):
+    M, N = shape
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        range_m = tl.arange(0, meta['BLOCK_M'])
+        range_n = tl.arange(0, meta['BLOCK_N'])
+        off = range_m[:, None] * meta['BLOCK_N'] + range_n[None, :]
+        x = tl.load(X + off)
+        z = GENERATE_TEST_HERE
+        tl.store(Z + off, z)
+
+    kernel = patch_kernel(kernel, {'GENERATE_TEST_HERE': f'tl.{op}(x, axis=meta["AXIS"], exclusive=meta["EXCLUSIVE"])'})
+    x = torch.randint(-8, 8, (M, N), device=device).to(cvt[dtype_str])
+    # reference computed in float64 on the host; small integers keep float sums exact
+    x_ref = x.cpu().to(torch.float64)
+    if op == 'cumsum':
+        z_ref, identity = torch.cumsum(x_ref, dim=axis), 0
+    elif op == 'cummax':
+        z_ref, identity = torch.cummax(x_ref, dim=axis)[0], float('-inf')
+    else:
+        z_ref, identity = torch.cummin(x_ref, dim=axis)[0], float('inf')
+    if exclusive:
+        if dtype_str == 'int32' and op != 'cumsum':
+            identity = torch.iinfo(torch.int32).min if op == 'cummax' else torch.iinfo(torch.int32).max
+        first = torch.full_like(z_ref.narrow(axis, 0, 1), identity)
+        z_ref = torch.cat([first, z_ref.narrow(axis, 0, z_ref.shape[axis] - 1)], dim=axis)
+    z_tri = torch.empty_like(x)
+    binary = kernel[(1, )](x, z_tri, BLOCK_M=M, BLOCK_N=N, AXIS=axis, EXCLUSIVE=exclusive)
+    assert torch.equal(z_ref.to(z_tri.dtype), z_tri.cpu())
+    # one barrier at most, whatever the number of warps along `axis`
+    llir = binary.asm('llir')
+    assert llir.count('call void @llvm.nvvm.barrier0()') <= 1
+
+
+# ---------------
+# test division by constants
+# ---------------
+@pytest.mark.parametrize("divisor", [1, 8, 6, 7, 1000])
+def test_div_rem_pid(divisor, device='cuda'):
+    @triton.jit
+    def kernel(Q, R, **meta):
+        pid = tl.program_id(0)
+        tl.store(Q + pid, pid // meta['DIVISOR'])
+        tl.store(R + pid, pid % meta['DIVISOR'])
+
+    N = 4096
+    q = torch.empty(N, dtype=torch.int32, device=device)
+    r = torch.empty(N, dtype=torch.int32, device=device)
+    binary = kernel[(N, )](q, r, DIVISOR=divisor)
+    pid = torch.arange(N, dtype=torch.int32, device=device)
+    assert torch.equal(q, pid // divisor)
+    assert torch.equal(r, pid % divisor)
+    assert binary.report['strength_reduction.div_rem'] == 2
+
+
+
+@pytest.mark.parametrize("divisor", [7, 64, 1000, -3, 2**31 - 1])
+def test_div_rem_runtime(divisor, device='cuda'):
+    @triton.jit
+    def kernel(Q, R, divisor, **meta):
+        pid = tl.program_id(0)
+        # large non-negative dividends, which are known not to wrap around
+        x = (pid & 65535) * 32767
+        tl.store(Q + pid, x // divisor)
+        tl.store(R + pid, x % divisor)
+
+    N = 4096
+    q = torch.empty(N, dtype=torch.int32, device=device)
+    r = torch.empty(N, dtype=torch.int32, device=device)
+    binary = kernel[(N, )](q, r, divisor)
+    x = torch.arange(N, dtype=torch.int32, device=device) * 32767
+    assert torch.equal(q, torch.div(x, divisor, rounding_mode='trunc'))
+    assert torch.equal(r, torch.fmod(x, divisor))
+    assert binary.report['strength_reduction.div_rem'] == 2
+    ptx = binary.asm('ptx')
+    assert 'div.s32' not in ptx
+    assert 'rem.s32' not in ptx
+
+
+def test_div_rem_wraparound(device='cuda'):
+    @triton.jit
+    def kernel(Q, R, stride, **meta):
+        pid = tl.program_id(0)
+        # may wrap around to negative values
+        x = pid * stride
+        tl.store(Q + pid, x // 7)
+        tl.store(R + pid, x % 7)
+
+    N, stride = 16, 2**30
+    q = torch.empty(N, dtype=torch.int32, device=device)
+    r = torch.empty(N, dtype=torch.int32, device=device)
+    binary = kernel[(N, )](q, r, stride)
+    x = torch.arange(N, dtype=torch.int32, device=device) * stride
+    assert torch.equal(q, torch.div(x, 7, rounding_mode='trunc'))
+    assert torch.equal(r, torch.fmod(x, 7))
+    assert binary.report['strength_reduction.div_rem'] == 0
+
+
+def test_div_rem_matmul(monkeypatch, device='cuda'):
+    # grouped ordering of tutorials/03-matrix-multiplication.py
+    @triton.jit
+    def kernel(A, B, C, M, N, K, stride_am, stride_ak, stride_bk, stride_bn, stride_cm, stride_cn, **meta):
+        BLOCK_M, BLOCK_N, BLOCK_K = meta['BLOCK_M'], meta['BLOCK_N'], meta['BLOCK_K']
+        GROUP_M = 8
+        pid = tl.program_id(0)
+        grid_m = (M + BLOCK_M - 1) // BLOCK_M
+        grid_n = (N + BLOCK_N - 1) // BLOCK_N
+        width = GROUP_M * grid_n
+        group_id = pid // width
+        group_size = min(grid_m - group_id * GROUP_M, GROUP_M)
+        pid_m = group_id * GROUP_M + (pid % group_size)
+        pid_n = (pid % width) // group_size
+        rm = pid_m * BLOCK_M + tl.arange(0, BLOCK_M)
+        rn = pid_n * BLOCK_N + tl.arange(0, BLOCK_N)
+        rk = tl.arange(0, BLOCK_K)
+        A = A + (rm[:, None] * stride_am + rk[None, :] * stride_ak)
+        B = B + (rk[:, None] * stride_bk + rn[None, :] * stride_bn)
+        acc = tl.zeros((BLOCK_M, BLOCK_N), dtype=tl.float32)
+        for k in range(0, K, BLOCK_K):
+            acc += tl.dot(tl.load(A), tl.load(B))
+            A += BLOCK_K * stride_ak
+            B += BLOCK_K * stride_bk
+        C = C + (rm[:, None] * stride_cm + rn[None, :] * stride_cn)
+        tl.store(C, acc)
+
+    M, N, K = 512, 512, 128
+    a = torch.randn((M, K), dtype=torch.float16, device=device)
+    b = torch.randn((K, N), dtype=torch.float16, device=device)
+    c = torch.empty((M, N), dtype=torch.float32, device=device)
+
+    def run():
+        kernel.cache.clear()
+        binary = kernel[(M // 64 * N // 64, )](a, b, c, M, N, K, a.stride(0), a.stride(1), b.stride(0), b.stride(1),
+                                               c.stride(0), c.stride(1), BLOCK_M=64, BLOCK_N=64, BLOCK_K=32)
+        triton.testing.assert_allclose(torch.matmul(a.float(), b.float()), c)
+        ptx = binary.asm('ptx')
+        return binary, sum(op in line for line in ptx.split('\n') for op in ['div.s32', 'rem.s32'])
+
+    on, num_on = run()
+    monkeypatch.setenv('TRITON_DISABLE_STRENGTH_REDUCTION', '1')
+    off, num_off = run()
+    # the divisions of the program id by the size of the groups
+    assert on.report['strength_reduction.div_rem'] == 4
+    assert off.report['strength_reduction.div_rem'] == 0
+    assert num_on < num_off
+
 # ---------------
 # test load
 # ---------------
+@pytest.mark.parametrize("cache, eviction", [
+    (cache, eviction) for cache in ['', '.ca', '.cg', '.cs', '.lu'] \
+                      for eviction in ['', 'evict_first', 'evict_last']
+])
+def test_load_cache_hints(cache, eviction, device='cuda'):
+    N = 128
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['N'])
+        x = tl.load(X + off, cache_modifier=meta['CACHE'], eviction_policy=meta['EVICTION'])
+        tl.store(Z + off, x)
+
+    x = torch.randn(N, device=device)
+    z = torch.empty_like(x)
+    binary = kernel[(1, )](x, z, N=N, CACHE=cache, EVICTION=eviction)
+    assert torch.equal(x, z)
+    ptx = binary.asm('ptx')
+    assert f'ld.global{cache or ".cg"}' in ptx
+    has_hint = eviction != '' and torch.cuda.get_device_capability(device)[0] >= 8
+    assert ('L2::cache_hint' in ptx) == has_hint
+    if has_hint:
+        assert f'createpolicy.fractional.L2::{eviction}' in ptx
+
+
+@pytest.mark.parametrize("eviction", ['', 'evict_last'])
+def test_dot_cache_hints(eviction, device='cuda'):
+    if torch.cuda.get_device_capability(device)[0] < 8:
+        pytest.skip("Only test cp.async cache hints on devices with sm >= 80")
+    M, N, K = 64, 64, 32
+
+    @triton.jit
+    def kernel(X, Y, Z, **meta):
+        rm = tl.arange(0, meta['M'])
+        rn = tl.arange(0, meta['N'])
+        rk = tl.arange(0, meta['K'])
+        # masked operands of dots are copied with cp.async on sm80
+        x = tl.load(X + rm[:, None] * meta['K'] + rk[None, :], mask=rk[None, :] < meta['K'],
+                    other=0., eviction_policy=meta['EVICTION'])
+        y = tl.load(Y + rk[:, None] * meta['N'] + rn[None, :], mask=rk[:, None] < meta['K'],
+                    other=0., eviction_policy=meta['EVICTION'])
+        z = tl.dot(x, y)
+        tl.store(Z + rm[:, None] * meta['N'] + rn[None, :], z)
+
+    x = torch.randn((M, K), dtype=torch.float16, device=device)
+    y = torch.randn((K, N), dtype=torch.float16, device=device)
+    z = torch.empty((M, N), dtype=torch.float32, device=device)
+    binary = kernel[(1, )](x, y, z, M=M, N=N, K=K, EVICTION=eviction)
+    triton.testing.assert_allclose(torch.matmul(x.float(), y.float()), z)
+    copies = [line for line in binary.asm('ptx').split('\n')
+              if 'cp.async.ca' in line or 'cp.async.cg' in line]
+    assert copies
+    assert all(('L2::cache_hint' in line) == (eviction != '') for line in copies)
 
 # ---------------
 # test store
 # ---------------
+@pytest.mark.parametrize("cache, eviction", [
+    (cache, eviction) for cache in ['', '.wb', '.cg', '.cs', '.wt'] \
+                      for eviction in ['', 'evict_first', 'evict_last']
+])
+def test_store_cache_hints(cache, eviction, device='cuda'):
+    N = 128
+
+    @triton.jit
+    def kernel(X, Z, **meta):
+        off = tl.arange(0, meta['N'])
+        x = tl.load(X + off)
+        tl.store(Z + off, x, mask=off < meta['N'] - 1, cache_modifier=meta['CACHE'], eviction_policy=meta['EVICTION'])
+
+    x = torch.randn(N, device=device)
+    z = torch.zeros_like(x)
+    binary = kernel[(1, )](x, z, N=N, CACHE=cache, EVICTION=eviction)
+    assert torch.equal(x[:-1], z[:-1]) and z[-1] == 0
+    ptx = binary.asm('ptx')
+    has_hint = eviction != '' and torch.cuda.get_device_capability(device)[0] >= 8
+    if cache:
+        assert f'st.global{cache}' in ptx
+    assert ('L2::cache_hint' in ptx) == has_hint
+
+
+def test_invalid_cache_modifier(device='cuda'):
+    @triton.jit
+    def kernel(X):
+        tl.store(X, tl.load(X, cache_modifier='.wt'))
+
+    x = torch.empty(1, device=device)
+    with pytest.raises(Exception):
+        kernel[(1, )](x)
 
 # ---------------
 # test if
 # ---------------
+@pytest.mark.parametrize("use_y", [False, True])
+def test_dead_if(use_y, device='cuda'):
+    @triton.jit
+    def kernel(X, Z, N, **meta):
+        x = tl.load(X)
+        y = x
+        if N > 0:
+            y = x * 2
+        if meta['USE_Y']:
+            x = y
+        tl.store(Z, x)
+
+    x = torch.tensor([3.], device=device)
+    z = torch.empty_like(x)
+    binary = kernel[(1, )](x, z, 5, USE_Y=use_y)
+    assert z.item() == (6. if use_y else 3.)
+    # the `if` region is only removed when nothing depends on it
+    assert (binary.report['dce.dead_branches'] > 0) == (not use_y)
 
 # ---------------
 # test for
@@ -408,15 +408,18 @@ class CodeGenerator(ast.NodeVisitor):
 
 
 class Binary:
-    def __init__(self, module, kernel, num_warps, num_stages, force_nc_cache, shared_mem, ir_asm):
+    def __init__(self, module, kernel, num_warps, num_stages, force_nc_cache, unroll_max_size, shared_mem, ir_asm, report):
         # cache ir asm
         self.ir_asm = ir_asm
+        # compile-time statistics gathered by the passes
+        self.report = report
         self.module = module
         self.kernel = kernel
         self.shared_mem = shared_mem
         self.num_warps = num_warps
         self.num_stages = num_stages
         self.force_nc_cache = force_nc_cache
+        self.unroll_max_size = unroll_max_size
         self.sass = None
 
     def asm(self, mode):
@@ -522,10 +525,20 @@ class Kernel:
         if N % 2 == 0: return 2
         return 1
 
+    # alignments that arguments are specialized for. Integer arguments are
+    # not part of the cache key: all the variants are compiled at once, and
+    # the one to launch is picked from the arguments of each call
+    alignment_variants = (16, 8, 4, 1)
+
+    @staticmethod
+    def alignment_variant(N):
+        divisor = Kernel.pow2_divisor(N)
+        return builtins.max(v for v in Kernel.alignment_variants if v <= divisor)
+
     def __init__(self, fn):
         self.fn = fn
 
-    def _compile(self, *wargs, device, attributes, constants, num_warps, num_stages, force_nc_cache, **meta):
+    def _compile(self, *wargs, device, attributes, constants, num_warps, num_stages, force_nc_cache, unroll_max_size, **meta):
         # explicitly set device
         torch.cuda.set_device(device.index)
         # create IR module
@@ -547,12 +560,12 @@ class Kernel:
             raise CompilationError(self.fn.src, node, e)
         tt_device = _triton.driver.cu_device(device.index, False)
         # Compile to machine code
-        mod, ker, shared_mem, ir_asm = _triton.code_gen.add_passes_to_emit_bin(generator.module, tt_device, num_warps, num_stages, force_nc_cache)
+        mod, ker, shared_mem, ir_asm, report = _triton.code_gen.add_passes_to_emit_bin(generator.module, tt_device, num_warps, num_stages, force_nc_cache, unroll_max_size)
         if shared_mem > tt_device.max_shared_memory():
             raise  OutOfResources(shared_mem, tt_device.max_shared_memory(), "shared memory")
-        return Binary(mod, ker, num_warps, num_stages, force_nc_cache, shared_mem, ir_asm)
+        return Binary(mod, ker, num_warps, num_stages, force_nc_cache, unroll_max_size, shared_mem, ir_asm, report)
 
-    def __call__(self, *wargs, grid, num_warps=4, num_stages=2, force_nc_cache=False, **meta):
+    def __call__(self, *wargs, grid, num_warps=4, num_stages=2, force_nc_cache=False, unroll_max_size=128, **meta):
         # device inference
         tensor_idxs = [i for i, arg in enumerate(wargs) if hasattr(arg, 'data_ptr')]
         if len(tensor_idxs) == 0:
@@ -569,28 +582,36 @@ class Kernel:
         torch.cuda.set_device(device.index)
         # attributes
         args = [arg.data_ptr() if i in tensor_idxs else arg for i, arg in enumerate(wargs)]
-        attributes = {i: Kernel.pow2_divisor(a) for i, a in enumerate(args) if isinstance(a, int)}
         # transforms ints whose value is one into constants for just-in-time compilation
         constants = {i: arg for i, arg in enumerate(wargs) if isinstance(arg, int) and arg == 1}
+        # each pointer is assumed to be a multiple of the largest variant
+        # that divides it, and is part of the cache key
+        int_idxs = [i for i, a in enumerate(args) if isinstance(a, int) and i not in tensor_idxs and i not in constants]
+        attributes = {i: Kernel.alignment_variant(args[i]) for i in tensor_idxs}
+        # integers are assumed to be multiples of the same variant, which is
+        # the largest one that divides all of them
+        variants = Kernel.alignment_variants if int_idxs else (1, )
+        variant = builtins.min([Kernel.alignment_variant(args[i]) for i in int_idxs], default=1)
         # determine if we need to re-compile
         types_key = Kernel._types_key(*wargs, tensor_idxs=tensor_idxs)
         attr_key = frozenset(attributes.items())
         meta_key = frozenset(meta.items())
         const_key = frozenset(constants.items())
-        key = (device.type, device.index, types_key, attr_key, num_warps, num_stages, meta_key, const_key)
+        key = (device.type, device.index, types_key, attr_key, num_warps, num_stages, unroll_max_size, meta_key, const_key)
         cache = self.fn.cache
         if key not in cache:
-            # compile and cache configuration if necessary
-            cache[key] = self._compile(
-                *wargs, device=device, attributes=attributes, 
-                num_warps=num_warps, num_stages=num_stages, force_nc_cache=force_nc_cache, 
+            # compile and cache all the alignment variants if necessary
+            cache[key] = {v: self._compile(
+                *wargs, device=device, attributes={**attributes, **{i: v for i in int_idxs}},
+                num_warps=num_warps, num_stages=num_stages, force_nc_cache=force_nc_cache,
+                unroll_max_size=unroll_max_size,
                 constants=constants, **meta
-            )
+            ) for v in variants}
         # pack arguments
         fmt = ''.join(['P' if i in tensor_idxs else Kernel._type_name(arg.__class__) for i, arg in enumerate(wargs)])
         params = struct.pack(fmt, *args)
         # enqueue cached function into stream
-        binary = cache[key]
+        binary = cache[key][variant]
         cu_stream = torch.cuda.current_stream(device.index).cuda_stream
         stream = _triton.driver.cu_stream(cu_stream, False)
         grid = grid(meta) if hasattr(grid, '__call__') else grid
@@ -370,18 +370,21 @@ def reshape(input, shape, builder=None):
 
 
 @builtin
-def dot(input, other, builder=None):
+def dot(input, other, allow_tf32=False, builder=None):
     """
     Returns the matrix product of two blocks.
 
     The two blocks must be two dimensionals and have compatible inner dimensions.
+    Products of :code:`int8` blocks are accumulated in :code:`int32`.
 
     :param input: The first block to be multiplied.
-    :type input: 2D block of scalar-type in {:code:`float16`, :code:`float32`}
+    :type input: 2D block of scalar-type in {:code:`float16`, :code:`float32`, :code:`int8`}
     :param other: The second block to be multiplied.
-    :type other: 2D block of scalar-type in {:code:`float16`, :code:`float32`}
+    :type other: 2D block of scalar-type in {:code:`float16`, :code:`float32`, :code:`int8`}
+    :param allow_tf32: Whether :code:`float32` blocks may be rounded to tf32 to use tensor cores (sm80+)
+    :type allow_tf32: bool, optional
     """
-    return frontend.dot(input, other, builder)
+    return frontend.dot(input, other, allow_tf32, builder)
 
 
 # -----------------------
@@ -390,7 +393,7 @@ def dot(input, other, builder=None):
 
 
 @builtin
-def load(pointer, mask=None, other=None, builder=None):
+def load(pointer, mask=None, other=None, cache_modifier="", eviction_policy="", builder=None):
     """
     Return a block of data whose values are, elementwise, loaded from memory at location defined by :code:`pointer`.
 
@@ -404,12 +407,16 @@ def load(pointer, mask=None, other=None, builder=None):
     :type mask: Block of triton.int1, optional
     :param other: if mask[idx] is false, return other[idx]
     :type other: Block, optional
+    :param cache_modifier: PTX cache operator of the load: ".ca" (all levels), ".cg" (L2 only), ".cs" (streaming) or ".lu" (last use).
+    :type cache_modifier: str, optional
+    :param eviction_policy: L2 eviction priority on sm80+: "evict_first" or "evict_last". Ignored on older devices.
+    :type eviction_policy: str, optional
     """
-    return frontend.load(pointer, mask, other, builder)
+    return frontend.load(pointer, mask, other, cache_modifier, eviction_policy, builder)
 
 
 @builtin
-def store(pointer, value, mask=None, builder=None):
+def store(pointer, value, mask=None, cache_modifier="", eviction_policy="", builder=None):
     """
     Stores :code:`value` block of elements in memory, element-wise, at the memory locations specified by :code:`pointer`. 
 
@@ -421,8 +428,12 @@ def store(pointer, value, mask=None, builder=None):
     :type value: Block
     :param mask: If mask[idx] is false, do not store :code:`value[idx]` at :code:`pointer[idx]`.
     :type mask: Block of triton.int1, optional
+    :param cache_modifier: PTX cache operator of the store: ".wb" (write-back), ".cg" (L2 only), ".cs" (streaming) or ".wt" (write-through).
+    :type cache_modifier: str, optional
+    :param eviction_policy: L2 eviction priority on sm80+: "evict_first" or "evict_last". Ignored on older devices.
+    :type eviction_policy: str, optional
     """
-    return frontend.store(pointer, value, mask, builder)
+    return frontend.store(pointer, value, mask, cache_modifier, eviction_policy, builder)
 
 
 @builtin
@@ -580,6 +591,106 @@ def sqrt(x, builder=None):
     return frontend.sqrt(x, builder)
 
 
+@builtin
+def exp2(x, approx=False, builder=None):
+    """
+    Computes the element-wise base-2 exponential of :code:`x`.
+
+    Evaluated in float32. The maximum error of float32 results is 1 ulp
+    by default, and 2 ulp when :code:`approx` is set.
+
+    :param x: the input values
+    :type x: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.exp2(x, approx, builder)
+
+
+@builtin
+def tanh(x, approx=False, builder=None):
+    """
+    Computes the element-wise hyperbolic tangent of :code:`x`.
+
+    Evaluated in float32. The maximum error of float32 results is 2 ulp
+    by default, and 4 ulp when :code:`approx` is set.
+
+    :param x: the input values
+    :type x: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.tanh(x, approx, builder)
+
+
+@builtin
+def erf(x, approx=False, builder=None):
+    """
+    Computes the element-wise error function of :code:`x`.
+
+    Evaluated in float32. The maximum error of float32 results is 2 ulp
+    by default, and 2 ulp when :code:`approx` is set.
+
+    :param x: the input values
+    :type x: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.erf(x, approx, builder)
+
+
+@builtin
+def sigmoid(x, approx=False, builder=None):
+    """
+    Computes the element-wise sigmoid :code:`1 / (1 + exp(-x))` of :code:`x`.
+
+    Evaluated in float32. The maximum error of float32 results is 3 ulp
+    by default, and 4 ulp for :code:`x >= 0`
+    and a relative error of :code:`2^-21 * (1 + |x|)` otherwise when :code:`approx` is set.
+
+    :param x: the input values
+    :type x: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.sigmoid(x, approx, builder)
+
+
+@builtin
+def rsqrt(x, approx=False, builder=None):
+    """
+    Computes the element-wise reciprocal square root of :code:`x`.
+
+    Evaluated in float32. The maximum error of float32 results is 2 ulp
+    by default, and a relative error of :code:`2^-22` when :code:`approx` is set.
+
+    :param x: the input values
+    :type x: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.rsqrt(x, approx, builder)
+
+
+@builtin
+def pow(x, y, approx=False, builder=None):
+    """
+    Computes the element-wise power :code:`x ** y`. :code:`x` and :code:`y` are broadcast to a common shape.
+
+    Evaluated in float32. The maximum error of float32 results is 2 ulp
+    by default, and a relative error of :code:`2^-21 * (1 + |y| + |y * log2(x)|)`
+    when :code:`approx` is set.
+
+    :param x: the base
+    :type x: Block
+    :param y: the exponent
+    :type y: Block
+    :param approx: use the faster :code:`*.approx.f32` PTX instructions
+    :type approx: bool
+    """
+    return frontend.pow(x, y, approx, builder)
+
+
 # -----------------------
 # Reductions
 # -----------------------
@@ -619,6 +730,77 @@ def sum(input, axis, builder=None):
     return frontend.sum(input, axis, builder)
 
 
+@builtin
+def argmin(input, axis, builder=None):
+    """
+    Returns the index of the minimum value of all elements in the :code:`input` block along the provided :code:`axis`.
+    Ties are broken in favor of the smallest index, and NaNs compare smaller than any other value.
+
+    :param input: the input values
+    :param axis: the dimension along which the reduction should be done
+    """
+    return frontend.argmin(input, axis, builder)
+
+
+@builtin
+def argmax(input, axis, builder=None):
+    """
+    Returns the index of the maximum value of all elements in the :code:`input` block along the provided :code:`axis`.
+    Ties are broken in favor of the smallest index, and NaNs compare greater than any other value.
+
+    :param input: the input values
+    :param axis: the dimension along which the reduction should be done
+    """
+    return frontend.argmax(input, axis, builder)
+
+
+# -----------------------
+# Scans
+# -----------------------
+
+
+@builtin
+def cumsum(input, axis, exclusive=False, builder=None):
+    """
+    Returns the cumulative sum of the elements in the :code:`input` block along the provided :code:`axis`.
+    When :code:`exclusive` is set, element :code:`i` only covers elements :code:`0, ..., i-1`
+    and the first element is the identity of the operation.
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    :param exclusive: whether to exclude the current element
+    """
+    return frontend.cumsum(input, axis, exclusive, builder)
+
+
+@builtin
+def cummax(input, axis, exclusive=False, builder=None):
+    """
+    Returns the cumulative maximum of the elements in the :code:`input` block along the provided :code:`axis`.
+    When :code:`exclusive` is set, element :code:`i` only covers elements :code:`0, ..., i-1`
+    and the first element is the identity of the operation.
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    :param exclusive: whether to exclude the current element
+    """
+    return frontend.cummax(input, axis, exclusive, builder)
+
+
+@builtin
+def cummin(input, axis, exclusive=False, builder=None):
+    """
+    Returns the cumulative minimum of the elements in the :code:`input` block along the provided :code:`axis`.
+    When :code:`exclusive` is set, element :code:`i` only covers elements :code:`0, ..., i-1`
+    and the first element is the identity of the operation.
+
+    :param input: the input values
+    :param axis: the dimension along which the scan should be done
+    :param exclusive: whether to exclude the current element
+    """
+    return frontend.cummin(input, axis, exclusive, builder)
+
+
 # -----------------------
 # Internal for debugging
 # -----------------------
@@ -668,17 +850,6 @@ def maximum(x, y):
     return triton.language.where(x > y, x, y)
 
 
-@triton.jit
-def sigmoid(x):
-    """
-    Computes the element-wise sigmoid of :code:`x`.
-
-    :param x: the input block
-    :type x: Block
-    """
-    return 1 / (1 + triton.language.exp(-x))
-
-
 @triton.jit
 def softmax(x):
     """